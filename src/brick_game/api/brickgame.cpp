@@ -0,0 +1,190 @@
+#include "./inc/brickgame.h"
+
+#include <new>
+
+#include "../common/inc/frame_buffer.h"
+#include "../common/inc/rng.h"
+#include "../snake/controller/inc/game_controller.h"
+#include "../tetris/inc/fsm_t.h"
+
+static_assert(BG_FIELD_WIDTH == FIELD_WIDTH &&
+                  BG_FIELD_HEIGHT == FIELD_HEIGHT &&
+                  BG_NEXT_SIZE == FIGURE_SIZE,
+              "the observation must match the engine field");
+
+/**
+ * @struct BgEnv
+ * @brief Structure representing one environment and its reusable game.
+ * @var BgEnv.game Game of the environment.
+ * @var BgEnv.seeds Source of episode seeds when the caller passes none.
+ * @var BgEnv.tetris Tetris game, NULL for snake.
+ * @var BgEnv.snake Snake model, nullptr for tetris.
+ * @var BgEnv.frame Scratch frame the observation is packed from.
+ * @var BgEnv.score Score of the episode.
+ * @var BgEnv.level Level of the episode.
+ * @var BgEnv.reward Score gained by the last step.
+ * @var BgEnv.steps Steps taken since the last reset.
+ * @var BgEnv.status BgStatus of the episode.
+ */
+struct BgEnv {
+  BgGame game;
+  Rng seeds;
+  GameInfo_t *tetris;
+  s21::GameModel *snake;
+  Frame frame;
+  int score;
+  int level;
+  int reward;
+  int steps;
+  BgStatus status;
+};
+
+static const UserAction_t bg_actions[] = {IDLE, Left, Right, Up, Down, Action};
+
+static void reset_env(BgEnv *env, uint64_t seed) {
+  if (env->game == BG_TETRIS) {
+    piece_generator_init(env->tetris->generator, PIECES_BAG, seed);
+    reset_game(env->tetris);
+    spawn_new(env->tetris);
+    apply_user_action(env->tetris, Start);
+    env->level = env->tetris->level;
+  } else {
+    env->snake->Restart(seed);
+    s21::GameController(env->snake).userInput(Start, false);
+    env->level = env->snake->GetLevel();
+  }
+  env->score = 0;
+  env->reward = 0;
+  env->steps = 0;
+  env->status = BG_RUNNING;
+}
+
+static void step_tetris(BgEnv *env, UserAction_t action) {
+  GameInfo_t *game = env->tetris;
+  game->action = action;
+  calculate_game(game);
+  env->reward = game->score - env->score;
+  env->score = game->score;
+  env->level = game->level;
+  if (game->status == GAMEOVER) env->status = BG_GAME_OVER;
+}
+
+static void step_snake(BgEnv *env, UserAction_t action) {
+  s21::GameModel *model = env->snake;
+  if (action != IDLE && action != Action) {
+    s21::GameController(model).userInput(action, false);
+  }
+  model->UpdateGame();
+  GameState state = model->GetGameState();
+  if (state == GameOver) {
+    // The model restarts itself on a loss, so keep the finished episode.
+    env->reward = 0;
+    env->status = BG_GAME_OVER;
+    return;
+  }
+  env->reward = model->GetScore() - env->score;
+  env->score = model->GetScore();
+  env->level = model->GetLevel();
+  if (state == Win) env->status = BG_WIN;
+}
+
+static void observe(BgEnv *env, BgObservation *obs) {
+  if (env->game == BG_TETRIS) {
+    snapshot_game(env->tetris, &env->frame);
+  } else {
+    env->snake->Snapshot(&env->frame);
+  }
+  for (int row = 0; row < FIELD_HEIGHT; row++) {
+    memcpy(obs->field[row], env->frame.field[row], FIELD_WIDTH);
+  }
+  memcpy(obs->next, env->frame.next, sizeof(obs->next));
+  obs->status = (uint8_t)env->status;
+  obs->done = env->status != BG_RUNNING;
+  obs->reserved = 0;
+  obs->score = env->score;
+  obs->level = env->level;
+  obs->reward = env->reward;
+  obs->steps = env->steps;
+}
+
+static BgEnv *create_env(BgGame game, uint64_t seed) {
+  BgEnv *env = new (std::nothrow) BgEnv();
+  if (env == nullptr) return nullptr;
+  env->game = game;
+  rng_seed(&env->seeds, seed);
+  env->tetris = NULL;
+  env->snake = nullptr;
+  if (game == BG_TETRIS) {
+    env->tetris = game_init_seeded(PIECES_BAG, seed);
+  } else {
+    try {
+      env->snake = new s21::GameModel(false, seed);
+    } catch (const std::bad_alloc &) {
+      env->snake = nullptr;
+    }
+  }
+  if (env->tetris == NULL && env->snake == nullptr) {
+    delete env;
+    return nullptr;
+  }
+  reset_env(env, seed);
+  return env;
+}
+
+static void destroy_env(BgEnv *env) {
+  if (env->tetris != NULL) free_game_init(env->tetris);
+  delete env->snake;
+  delete env;
+}
+
+int bg_abi_version(void) { return BG_ABI_VERSION; }
+
+int bg_create_batch(BgGame game, const uint64_t *seeds, int n,
+                    BgEnv **handles) {
+  if (game != BG_TETRIS && game != BG_SNAKE) return -1;
+  for (int i = 0; i < n; i++) {
+    handles[i] = create_env(game, seeds ? seeds[i] : rng_random_seed());
+    if (handles[i] == nullptr) {
+      bg_destroy_batch(handles, i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void bg_destroy_batch(BgEnv **handles, int n) {
+  for (int i = 0; i < n; i++) {
+    if (handles[i] != nullptr) destroy_env(handles[i]);
+    handles[i] = nullptr;
+  }
+}
+
+void bg_reset_batch(BgEnv **handles, const uint64_t *seeds, int n,
+                    BgObservation *out_obs) {
+  for (int i = 0; i < n; i++) {
+    BgEnv *env = handles[i];
+    reset_env(env, seeds ? seeds[i] : rng_next(&env->seeds));
+    if (out_obs != NULL) observe(env, &out_obs[i]);
+  }
+}
+
+void bg_step_batch(BgEnv **handles, const int32_t *actions, int n,
+                   BgObservation *out_obs) {
+  for (int i = 0; i < n; i++) {
+    BgEnv *env = handles[i];
+    int32_t action = actions[i];
+    if (env->status == BG_RUNNING) {
+      UserAction_t user_action =
+          action >= BG_NONE && action <= BG_ACTION ? bg_actions[action] : IDLE;
+      if (env->game == BG_TETRIS) {
+        step_tetris(env, user_action);
+      } else {
+        step_snake(env, user_action);
+      }
+      env->steps++;
+    } else {
+      env->reward = 0;
+    }
+    if (out_obs != NULL) observe(env, &out_obs[i]);
+  }
+}
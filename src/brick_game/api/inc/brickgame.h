@@ -0,0 +1,153 @@
+/**
+ * @file brickgame.h
+ * @brief Header file containing the C ABI of libbrickgame, the game engines
+ * packaged as batched environments.
+ *
+ * An environment is one game instance behind an opaque handle. All calls
+ * take arrays of handles, so a caller driving many environments pays the
+ * call overhead once per batch instead of once per game. Environments
+ * allocate everything when they are created; resetting and stepping never
+ * allocate and write observations into caller-owned arrays.
+ *
+ * Handles are independent: different handles may be used from different
+ * threads at the same time, one handle only from one thread at a time.
+ *
+ * The header is plain C and stays compatible within one BG_ABI_VERSION.
+ */
+
+#ifndef BRICKGAME_H
+#define BRICKGAME_H
+
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define BG_API __attribute__((visibility("default")))
+#else
+#define BG_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BG_ABI_VERSION 1 /**< Version of this interface. */
+#define BG_FIELD_WIDTH 10  /**< Width of the observed field. */
+#define BG_FIELD_HEIGHT 20 /**< Height of the observed field. */
+#define BG_NEXT_SIZE 5     /**< Size of the observed next figure preview. */
+
+/**
+ * @brief Enumeration of games.
+ */
+typedef enum { BG_TETRIS = 0, BG_SNAKE = 1 } BgGame;
+
+/**
+ * @brief Enumeration of actions.
+ * - BG_NONE: Do nothing this step.
+ * - BG_LEFT, BG_RIGHT, BG_DOWN: Move the figure or turn the snake.
+ * - BG_UP: Rotate the figure or turn the snake up.
+ * - BG_ACTION: Drop the figure; no effect in snake.
+ */
+typedef enum {
+  BG_NONE = 0,
+  BG_LEFT = 1,
+  BG_RIGHT = 2,
+  BG_UP = 3,
+  BG_DOWN = 4,
+  BG_ACTION = 5
+} BgAction;
+
+/**
+ * @brief Enumeration of episode states.
+ */
+typedef enum { BG_RUNNING = 0, BG_GAME_OVER = 1, BG_WIN = 2 } BgStatus;
+
+/**
+ * @struct BgObservation
+ * @brief Structure representing the state of an environment after a call.
+ * @var BgObservation.field Field cells, row-major, with the falling figure
+ * merged in: 0 empty, tetris figure colors 1 to 7, snake apple 2 and body 3.
+ * @var BgObservation.next Cells of the next tetris figure, zero for snake.
+ * @var BgObservation.status BgStatus of the episode.
+ * @var BgObservation.done 1 once the episode has ended; further steps do
+ * nothing until the environment is reset. A finished snake episode shows
+ * the restarted field.
+ * @var BgObservation.reserved Always zero.
+ * @var BgObservation.score Score of the episode.
+ * @var BgObservation.level Level of the episode.
+ * @var BgObservation.reward Score gained by the last step.
+ * @var BgObservation.steps Steps taken since the last reset.
+ */
+typedef struct BgObservation {
+  uint8_t field[BG_FIELD_HEIGHT][BG_FIELD_WIDTH];
+  uint8_t next[BG_NEXT_SIZE][BG_NEXT_SIZE];
+  uint8_t status;
+  uint8_t done;
+  uint8_t reserved;
+  int32_t score;
+  int32_t level;
+  int32_t reward;
+  int32_t steps;
+} BgObservation;
+
+/**
+ * @brief Opaque handle of one environment.
+ */
+typedef struct BgEnv BgEnv;
+
+/**
+ * @brief Returns the interface version the library was built with.
+ * @return BG_ABI_VERSION of the library.
+ */
+BG_API int bg_abi_version(void);
+
+/**
+ * @brief Creates environments, each ready to step from the start of an
+ * episode.
+ *
+ * Tetris deals figures from a 7-bag. An environment started with a given
+ * seed always plays the same game for the same actions.
+ *
+ * @param game Game of all created environments.
+ * @param seeds Seed of each environment, or NULL for random seeds.
+ * @param n Number of environments.
+ * @param handles Output array of n handles.
+ * @return 0 on success, -1 if game is not a BgGame value or memory ran out;
+ * nothing is created then.
+ */
+BG_API int bg_create_batch(BgGame game, const uint64_t *seeds, int n,
+                           BgEnv **handles);
+
+/**
+ * @brief Destroys environments. NULL handles are skipped.
+ * @param handles Array of n handles.
+ * @param n Number of environments.
+ */
+BG_API void bg_destroy_batch(BgEnv **handles, int n);
+
+/**
+ * @brief Starts a new episode in every environment.
+ * @param handles Array of n handles.
+ * @param seeds Seed of each new episode, or NULL to continue the seed
+ * sequence every environment derives from its creation seed.
+ * @param n Number of environments.
+ * @param out_obs Output array of n observations, or NULL.
+ */
+BG_API void bg_reset_batch(BgEnv **handles, const uint64_t *seeds, int n,
+                           BgObservation *out_obs);
+
+/**
+ * @brief Applies one action and advances every environment by one engine
+ * step: one tick of the tetris clock or one move of the snake.
+ * @param handles Array of n handles.
+ * @param actions BgAction of each environment.
+ * @param n Number of environments.
+ * @param out_obs Output array of n observations, or NULL.
+ */
+BG_API void bg_step_batch(BgEnv **handles, const int32_t *actions, int n,
+                          BgObservation *out_obs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+#include "./inc/frame_buffer.h"
+
+#include <string.h>
+
+void frame_buffer_init(FrameBuffer *buffer) {
+  memset(buffer->frames, 0, sizeof(buffer->frames));
+  buffer->write_index = 0;
+  buffer->shared.store(1, std::memory_order_relaxed);
+  buffer->read_index = 2;
+}
+
+Frame *frame_buffer_back(FrameBuffer *buffer) {
+  return &buffer->frames[buffer->write_index];
+}
+
+void frame_buffer_publish(FrameBuffer *buffer) {
+  unsigned previous = buffer->shared.exchange(
+      buffer->write_index | FRAME_BUFFER_FRESH, std::memory_order_acq_rel);
+  buffer->write_index = previous & FRAME_BUFFER_INDEX;
+}
+
+const Frame *frame_buffer_latest(FrameBuffer *buffer) {
+  if (buffer->shared.load(std::memory_order_relaxed) & FRAME_BUFFER_FRESH) {
+    unsigned previous = buffer->shared.exchange(buffer->read_index,
+                                                std::memory_order_acq_rel);
+    buffer->read_index = previous & FRAME_BUFFER_INDEX;
+  }
+  return &buffer->frames[buffer->read_index];
+}
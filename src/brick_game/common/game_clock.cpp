@@ -0,0 +1,53 @@
+#include "./inc/game_clock.h"
+
+#include <time.h>
+
+long long game_clock_now_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void game_clock_init(GameClock *clock, long long step_us, int max_steps) {
+  clock->step_us = step_us > 0 ? step_us : 1;
+  clock->accumulator_us = 0;
+  clock->last_us = 0;
+  clock->max_steps = max_steps > 0 ? max_steps : 1;
+  clock->running = false;
+}
+
+void game_clock_start(GameClock *clock, long long now_us) {
+  clock->accumulator_us = 0;
+  clock->last_us = now_us;
+  clock->running = true;
+}
+
+void game_clock_stop(GameClock *clock) {
+  clock->accumulator_us = 0;
+  clock->running = false;
+}
+
+void game_clock_set_step(GameClock *clock, long long step_us) {
+  clock->step_us = step_us > 0 ? step_us : 1;
+}
+
+void game_clock_update(GameClock *clock, long long now_us) {
+  if (!clock->running) return;
+  if (now_us > clock->last_us) clock->accumulator_us += now_us - clock->last_us;
+  clock->last_us = now_us;
+  long long limit = clock->step_us * clock->max_steps;
+  if (clock->accumulator_us > limit) clock->accumulator_us = limit;
+}
+
+bool game_clock_step(GameClock *clock) {
+  if (!clock->running || clock->accumulator_us < clock->step_us) return false;
+  clock->accumulator_us -= clock->step_us;
+  return true;
+}
+
+long long game_clock_time_to_step(const GameClock *clock, long long now_us) {
+  if (!clock->running) return -1;
+  long long elapsed = clock->accumulator_us;
+  if (now_us > clock->last_us) elapsed += now_us - clock->last_us;
+  return elapsed >= clock->step_us ? 0 : clock->step_us - elapsed;
+}
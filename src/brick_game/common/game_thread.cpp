@@ -0,0 +1,134 @@
+#include "./inc/game_thread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace s21 {
+
+GameThread::GameThread(ApplyFn apply, AdvanceFn advance, SnapshotFn snapshot,
+                       NotifyFn notify)
+    : apply_(std::move(apply)),
+      advance_(std::move(advance)),
+      snapshot_(std::move(snapshot)),
+      notify_(std::move(notify)) {
+  input_queue_init(&queue_);
+  frame_buffer_init(&frames_);
+}
+
+GameThread::~GameThread() { Stop(); }
+
+void GameThread::Start() {
+  if (thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = false;
+  }
+  thread_ = std::thread(&GameThread::Run, this);
+}
+
+void GameThread::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void GameThread::Share(SharedSession *session) {
+  if (!thread_.joinable()) shared_ = session;
+}
+
+bool GameThread::Post(UserAction_t action, bool hold) {
+  if (!thread_.joinable()) return false;
+  InputEvent event = {action, hold, game_clock_now_us()};
+  while (!input_queue_push(&queue_, &event)) {
+    wake_.notify_one();
+    std::this_thread::yield();
+  }
+  // Taking the mutex orders the push before the game thread's check for
+  // input, so the wakeup cannot be lost between that check and its sleep.
+  { std::lock_guard<std::mutex> lock(wake_mutex_); }
+  wake_.notify_one();
+  return true;
+}
+
+void GameThread::Run() {
+  while (true) {
+    long long wait_us;
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      ApplyQueued();
+      wait_us = advance_(game_clock_now_us());
+      Publish();
+    }
+    if (notify_) notify_();
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    if (stop_) break;
+    auto ready = [this] {
+      return stop_ || !input_queue_empty(&queue_) ||
+             (shared_ && shared_session_pending(shared_));
+    };
+    if (shared_) {
+      // Other processes cannot notify the thread, so it polls their commands.
+      using Clock = std::chrono::steady_clock;
+      Clock::time_point deadline =
+          wait_us < 0 ? Clock::time_point::max()
+                      : Clock::now() + std::chrono::microseconds(wait_us);
+      while (!ready() && Clock::now() < deadline) {
+        Clock::time_point poll =
+            Clock::now() + std::chrono::microseconds(SHARED_SESSION_POLL_US);
+        wake_.wait_until(lock, std::min(deadline, poll));
+      }
+    } else if (wait_us < 0) {
+      wake_.wait(lock, ready);
+    } else {
+      wake_.wait_for(lock, std::chrono::microseconds(wait_us), ready);
+    }
+  }
+  // Actions posted right before Stop() are still applied.
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  ApplyQueued();
+  Publish();
+}
+
+const Frame *GameThread::Latest() { return frame_buffer_latest(&frames_); }
+
+void GameThread::Publish() {
+  if (!snapshot_) return;
+  Frame *frame = frame_buffer_back(&frames_);
+  if (shared_) {
+    // The segment gets the snapshot itself; the local frontend a copy of it.
+    Frame *shared = shared_session_begin(shared_);
+    snapshot_(shared);
+    shared->sequence = ++sequence_;
+    shared_session_end(shared_);
+    memcpy(frame, shared, sizeof(Frame));
+  } else {
+    snapshot_(frame);
+    frame->sequence = ++sequence_;
+  }
+  frame_buffer_publish(&frames_);
+}
+
+void GameThread::ApplyQueued() {
+  InputEvent event;
+  while (input_queue_pop(&queue_, &event)) {
+    // Steps due before the key press happen before it is applied.
+    advance_(event.time_us);
+    apply_(event);
+  }
+  SharedCommand command;
+  while (shared_ && shared_session_pop(shared_, &command)) {
+    event = {(UserAction_t)command.action, command.hold != 0,
+             game_clock_now_us()};
+    advance_(event.time_us);
+    apply_(event);
+  }
+}
+
+}  // namespace s21
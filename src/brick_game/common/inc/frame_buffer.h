@@ -0,0 +1,96 @@
+/**
+ * @file frame_buffer.h
+ * @brief Header file containing the frame snapshots published by the game
+ * thread and the triple buffer that hands them to a renderer.
+ *
+ * A Frame is a flat copy of everything a renderer draws, with the falling
+ * figure already merged into the field, so it never points back into engine
+ * state. The producer always owns one of the three frames, the consumer owns
+ * another, and the third is exchanged through a single atomic index. Neither
+ * side ever waits for the other, and the renderer never sees a frame that is
+ * still being written.
+ */
+
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "../../inc/defines.h"
+
+#define FRAME_BUFFER_FRESH 4u /**< Flag marking an unread shared frame. */
+#define FRAME_BUFFER_INDEX 3u /**< Mask of the shared frame index. */
+
+/**
+ * @struct Frame
+ * @brief Structure representing one self-contained rendered game state.
+ * @var Frame.field Field cells with the current figure merged in.
+ * @var Frame.next Cells of the next figure preview.
+ * @var Frame.score Current score.
+ * @var Frame.high_score High score.
+ * @var Frame.level Current level.
+ * @var Frame.speed Current speed.
+ * @var Frame.pause Whether the game is paused.
+ * @var Frame.state Game state: the tetris status or the snake GameState.
+ * @var Frame.sequence Number of the frame, 0 before the first publish.
+ */
+typedef struct Frame {
+  alignas(FIELD_ALIGN) FieldRow field[FIELD_HEIGHT];
+  uint8_t next[FIGURE_SIZE][FIGURE_SIZE];
+  int score;
+  int high_score;
+  int level;
+  int speed;
+  int pause;
+  int state;
+  unsigned long long sequence;
+} Frame;
+
+/**
+ * @struct FrameBuffer
+ * @brief Structure representing a single-producer single-consumer triple
+ * buffer of frames.
+ * @var FrameBuffer.frames The three frames.
+ * @var FrameBuffer.shared Index of the exchanged frame and the fresh flag.
+ * @var FrameBuffer.write_index Frame owned by the producer.
+ * @var FrameBuffer.read_index Frame owned by the consumer.
+ */
+typedef struct FrameBuffer {
+  Frame frames[3];
+  std::atomic<unsigned> shared;
+  unsigned write_index;
+  unsigned read_index;
+} FrameBuffer;
+
+/**
+ * @brief Clears all frames. Must not run concurrently with other calls.
+ * @param buffer Pointer to the FrameBuffer structure.
+ */
+void frame_buffer_init(FrameBuffer *buffer);
+
+/**
+ * @brief Returns the frame the producer fills next.
+ * @param buffer Pointer to the FrameBuffer structure.
+ * @return Frame owned by the producer.
+ */
+Frame *frame_buffer_back(FrameBuffer *buffer);
+
+/**
+ * @brief Publishes the filled back frame to the consumer.
+ * @param buffer Pointer to the FrameBuffer structure.
+ */
+void frame_buffer_publish(FrameBuffer *buffer);
+
+/**
+ * @brief Returns the most recently published frame.
+ *
+ * The returned frame stays valid and unchanged until the next call.
+ *
+ * @param buffer Pointer to the FrameBuffer structure.
+ * @return Latest frame, with sequence 0 if nothing was published yet.
+ */
+const Frame *frame_buffer_latest(FrameBuffer *buffer);
+
+#endif
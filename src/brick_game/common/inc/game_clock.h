@@ -0,0 +1,91 @@
+/**
+ * @file game_clock.h
+ * @brief Header file containing the fixed timestep clock shared by the game
+ * engines.
+ *
+ * The frontend feeds the clock with the current time whenever it wakes up.
+ * Elapsed time is collected in an accumulator and handed out in whole steps,
+ * so the engines advance at an exact rate no matter how often they are
+ * rendered.
+ */
+
+#ifndef GAME_CLOCK_H
+#define GAME_CLOCK_H
+
+/**
+ * @struct GameClock
+ * @brief Structure representing a fixed timestep accumulator.
+ * @var GameClock.step_us Duration of one step in microseconds.
+ * @var GameClock.accumulator_us Elapsed time not yet consumed by steps.
+ * @var GameClock.last_us Time of the last update in microseconds.
+ * @var GameClock.max_steps Maximum number of steps kept in the accumulator,
+ * so a stalled frontend does not replay a long backlog at once.
+ * @var GameClock.running Whether the clock is collecting time.
+ */
+typedef struct GameClock {
+  long long step_us;
+  long long accumulator_us;
+  long long last_us;
+  int max_steps;
+  bool running;
+} GameClock;
+
+/**
+ * @brief Returns the monotonic clock time.
+ * @return Microseconds since an unspecified starting point.
+ */
+long long game_clock_now_us();
+
+/**
+ * @brief Initializes a stopped clock.
+ * @param clock Pointer to the GameClock structure.
+ * @param step_us Duration of one step in microseconds.
+ * @param max_steps Maximum number of steps kept in the accumulator.
+ */
+void game_clock_init(GameClock *clock, long long step_us, int max_steps);
+
+/**
+ * @brief Starts collecting time from the given moment with an empty
+ * accumulator.
+ * @param clock Pointer to the GameClock structure.
+ * @param now_us Current time in microseconds.
+ */
+void game_clock_start(GameClock *clock, long long now_us);
+
+/**
+ * @brief Stops collecting time and drops the accumulated time.
+ * @param clock Pointer to the GameClock structure.
+ */
+void game_clock_stop(GameClock *clock);
+
+/**
+ * @brief Changes the step duration, keeping the accumulated time.
+ * @param clock Pointer to the GameClock structure.
+ * @param step_us Duration of one step in microseconds.
+ */
+void game_clock_set_step(GameClock *clock, long long step_us);
+
+/**
+ * @brief Adds the time elapsed since the last update to the accumulator.
+ * @param clock Pointer to the GameClock structure.
+ * @param now_us Current time in microseconds.
+ */
+void game_clock_update(GameClock *clock, long long now_us);
+
+/**
+ * @brief Consumes one step from the accumulator if a whole step is due.
+ * @param clock Pointer to the GameClock structure.
+ * @return true if the caller should advance the game by one step.
+ */
+bool game_clock_step(GameClock *clock);
+
+/**
+ * @brief Returns the time left until the next step is due.
+ * @param clock Pointer to the GameClock structure.
+ * @param now_us Current time in microseconds.
+ * @return Microseconds until the next step, 0 if a step is already due, or -1
+ * if the clock is stopped.
+ */
+long long game_clock_time_to_step(const GameClock *clock, long long now_us);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file game_thread.h
+ * @brief Header file containing the thread that runs a game engine apart from
+ * its frontend.
+ *
+ * The frontend posts timestamped user actions into a lock-free queue and
+ * never touches the engine directly. The game thread applies every queued
+ * action in order, advances the engine at its own fixed rate and sleeps until
+ * the next step is due or new input arrives. After every update it publishes
+ * a Frame snapshot through a triple buffer, so a renderer reads the latest
+ * frame with Latest() without locking the engine. A thread sharing a
+ * SharedSession also publishes its frames there and applies the actions
+ * other processes send through it.
+ */
+
+#ifndef GAME_THREAD_H
+#define GAME_THREAD_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "frame_buffer.h"
+#include "game_clock.h"
+#include "input_queue.h"
+#include "shared_session.h"
+
+namespace s21 {
+
+/**
+ * @class GameThread
+ * @brief Runs a game engine on its own thread, fed by an input queue.
+ */
+class GameThread {
+ public:
+  /** Applies one user action to the engine. */
+  using ApplyFn = std::function<void(const InputEvent &)>;
+  /**
+   * Advances the engine to the given time and returns the microseconds until
+   * its next step, or -1 if it only waits for input.
+   */
+  using AdvanceFn = std::function<long long(long long now_us)>;
+  /** Fills a frame snapshot from the engine state. */
+  using SnapshotFn = std::function<void(Frame *)>;
+  /** Tells the frontend that a new frame was published. */
+  using NotifyFn = std::function<void()>;
+
+  /**
+   * @brief Constructs a stopped game thread.
+   *
+   * @param apply Callback applying one user action.
+   * @param advance Callback advancing the engine.
+   * @param snapshot Optional callback filling a frame after every update.
+   * @param notify Optional callback run on the game thread after every update.
+   */
+  GameThread(ApplyFn apply, AdvanceFn advance, SnapshotFn snapshot = nullptr,
+             NotifyFn notify = nullptr);
+
+  /**
+   * @brief Stops the thread if it is still running.
+   */
+  ~GameThread();
+
+  GameThread(const GameThread &) = delete;
+  GameThread &operator=(const GameThread &) = delete;
+
+  /**
+   * @brief Starts the game thread.
+   */
+  void Start();
+
+  /**
+   * @brief Stops the game thread and waits for it to finish.
+   */
+  void Stop();
+
+  /**
+   * @brief Publishes frames to a shared-memory session and applies the
+   * actions sent through it. Must be called while the thread is stopped.
+   *
+   * @param session Session to share, nullptr to stop sharing.
+   */
+  void Share(SharedSession *session);
+
+  /**
+   * @brief Queues a user action for the game thread.
+   *
+   * Must be called from a single frontend thread. If the queue is full the
+   * call waits for the game thread to make room, so no action is dropped.
+   *
+   * @param action User action.
+   * @param hold Whether the action key is held down.
+   * @return false if the thread is not running and the action was ignored.
+   */
+  bool Post(UserAction_t action, bool hold);
+
+  /**
+   * @brief Returns the most recently published frame.
+   *
+   * Must be called from a single renderer thread. The frame stays unchanged
+   * until the next call.
+   *
+   * @return Latest frame, with sequence 0 if nothing was published yet.
+   */
+  const Frame *Latest();
+
+  /**
+   * @brief Runs a function while the engine state is locked.
+   *
+   * @param fn Function reading the engine state.
+   * @return Result of the function.
+   */
+  template <typename Fn>
+  auto Read(Fn fn) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return fn();
+  }
+
+ private:
+  /**
+   * @brief Main loop of the game thread.
+   */
+  void Run();
+
+  /**
+   * @brief Applies every queued action. Called with the state locked.
+   */
+  void ApplyQueued();
+
+  /**
+   * @brief Publishes a snapshot of the engine state. Called with the state
+   * locked.
+   */
+  void Publish();
+
+  InputQueue queue_;          /**< Actions posted by the frontend. */
+  ApplyFn apply_;             /**< Callback applying one action. */
+  AdvanceFn advance_;         /**< Callback advancing the engine. */
+  SnapshotFn snapshot_;       /**< Callback filling a frame snapshot. */
+  NotifyFn notify_;           /**< Callback notifying the frontend. */
+  FrameBuffer frames_;        /**< Frames handed to the renderer. */
+  SharedSession *shared_ = nullptr; /**< Session of other processes. */
+  unsigned long long sequence_ = 0; /**< Number of the last published frame. */
+  std::mutex state_mutex_;    /**< Guards the engine state. */
+  std::mutex wake_mutex_;     /**< Guards stop_ and the sleep. */
+  std::condition_variable wake_; /**< Wakes the game thread early. */
+  bool stop_ = false;         /**< Whether the thread has to finish. */
+  std::thread thread_;        /**< The game thread. */
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file input_queue.h
+ * @brief Header file containing the single-producer single-consumer input
+ * queue between a frontend and the game thread.
+ *
+ * The frontend thread only writes the tail index and the game thread only
+ * writes the head index, so neither side ever takes a lock. The indices sit
+ * on separate cache lines to keep the two threads from invalidating each
+ * other on every event.
+ */
+
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <atomic>
+
+#include "../../inc/defines.h"
+
+#define INPUT_QUEUE_SIZE 64 /**< Capacity of the queue, a power of two. */
+#define INPUT_QUEUE_CACHE_LINE 64 /**< Cache line size used for padding. */
+
+/**
+ * @struct InputEvent
+ * @brief Structure representing one user action.
+ * @var InputEvent.action User action.
+ * @var InputEvent.hold Whether the action key is held down.
+ * @var InputEvent.time_us Monotonic time of the action in microseconds.
+ */
+typedef struct InputEvent {
+  UserAction_t action;
+  bool hold;
+  long long time_us;
+} InputEvent;
+
+/**
+ * @struct InputQueue
+ * @brief Structure representing a bounded lock-free ring of input events.
+ * @var InputQueue.head Index of the next event to pop, written by the consumer.
+ * @var InputQueue.tail Index of the next free slot, written by the producer.
+ * @var InputQueue.events Ring buffer of events.
+ */
+typedef struct InputQueue {
+  alignas(INPUT_QUEUE_CACHE_LINE) std::atomic<unsigned> head;
+  alignas(INPUT_QUEUE_CACHE_LINE) std::atomic<unsigned> tail;
+  alignas(INPUT_QUEUE_CACHE_LINE) InputEvent events[INPUT_QUEUE_SIZE];
+} InputQueue;
+
+/**
+ * @brief Empties the queue. Must not run concurrently with push or pop.
+ * @param queue Pointer to the InputQueue structure.
+ */
+void input_queue_init(InputQueue *queue);
+
+/**
+ * @brief Appends an event. Called only by the producer thread.
+ * @param queue Pointer to the InputQueue structure.
+ * @param event Event to append.
+ * @return false if the queue is full and the event was not added.
+ */
+bool input_queue_push(InputQueue *queue, const InputEvent *event);
+
+/**
+ * @brief Removes the oldest event. Called only by the consumer thread.
+ * @param queue Pointer to the InputQueue structure.
+ * @param event Receives the removed event.
+ * @return false if the queue is empty.
+ */
+bool input_queue_pop(InputQueue *queue, InputEvent *event);
+
+/**
+ * @brief Checks whether the queue has no events.
+ * @param queue Pointer to the InputQueue structure.
+ * @return true if the queue is empty.
+ */
+bool input_queue_empty(const InputQueue *queue);
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file replay.h
+ * @brief Header file containing the input recorder and the binary replay
+ * format shared by the game engines.
+ *
+ * Both engines are deterministic given their seed, the inputs they receive
+ * and the number of steps taken between inputs. A replay stores exactly
+ * that: the seed, every input tagged with the engine step it arrived at, the
+ * total number of steps and a hash of the final state to verify against.
+ *
+ * While recording, the engine also stores a checkpoint of its whole state
+ * every checkpoint_interval steps. Seeking to a step restores the nearest
+ * checkpoint before it and re-simulates only the inputs after that, instead
+ * of the whole session from the seed.
+ *
+ * File layout, integers little-endian:
+ * - "BGRP", u16 format version, u16 engine version, u8 game, u8 piece mode,
+ *   u64 seed, u32 number of inputs;
+ * - per input: varint step delta from the previous input, u8 action with
+ *   the hold flag in the top bit;
+ * - varint step delta of the end of the session, u64 final state hash;
+ * - since format version 2: varint checkpoint interval, varint number of
+ *   checkpoints, per checkpoint: varint step delta, varint input delta and
+ *   varint size from the previous checkpoint, then the engine state bytes.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define REPLAY_FORMAT_VERSION 2 /**< Version of the file layout. */
+/**
+ * Version of the game rules. Bump it whenever a change makes an engine
+ * produce a different state from the same inputs, so old replays are
+ * rejected instead of reported as diverged.
+ */
+#define REPLAY_ENGINE_VERSION 1
+#define REPLAY_RESET 15 /**< Input: the frontend restarted the game. */
+#define REPLAY_HOLD 0x80 /**< Hold flag bit of a stored input. */
+#define REPLAY_HASH_SEED 0xCBF29CE484222325ULL /**< FNV-1a offset basis. */
+#define REPLAY_CHECKPOINT_INTERVAL \
+  256 /**< Default number of steps between checkpoints. */
+#define REPLAY_CHECKPOINT_MAX 4096 /**< Largest engine state accepted. */
+
+/**
+ * @brief Enumeration of recorded games.
+ */
+typedef enum { REPLAY_TETRIS, REPLAY_SNAKE } ReplayGame;
+
+/**
+ * @struct ReplayInput
+ * @brief Structure representing one recorded input.
+ * @var ReplayInput.step Number of engine steps taken before the input.
+ * @var ReplayInput.action UserAction_t value or REPLAY_RESET.
+ * @var ReplayInput.hold Hold flag passed with the input.
+ */
+typedef struct ReplayInput {
+  unsigned long step;
+  uint8_t action;
+  bool hold;
+} ReplayInput;
+
+/**
+ * @struct ReplayCheckpoint
+ * @brief Structure representing a stored engine state.
+ * @var ReplayCheckpoint.step Number of engine steps taken before the state.
+ * @var ReplayCheckpoint.input Number of inputs applied before the state.
+ * @var ReplayCheckpoint.offset Offset of the state bytes in Replay.states.
+ * @var ReplayCheckpoint.size Size of the state bytes.
+ */
+typedef struct ReplayCheckpoint {
+  unsigned long step;
+  size_t input;
+  size_t offset;
+  size_t size;
+} ReplayCheckpoint;
+
+/**
+ * @struct Replay
+ * @brief Structure representing a recorded session.
+ * @var Replay.engine_version Engine version the session was recorded with.
+ * @var Replay.game Recorded game.
+ * @var Replay.mode Tetris piece randomizer, 0 for snake.
+ * @var Replay.seed Seed the game was created with.
+ * @var Replay.inputs Recorded inputs in arrival order.
+ * @var Replay.count Number of recorded inputs.
+ * @var Replay.capacity Allocated length of inputs.
+ * @var Replay.steps Number of engine steps taken so far.
+ * @var Replay.final_hash State hash at the end of the session.
+ * @var Replay.checkpoint_interval Steps between checkpoints, 0 to record
+ * none.
+ * @var Replay.checkpoints Stored checkpoints in step order.
+ * @var Replay.checkpoint_count Number of stored checkpoints.
+ * @var Replay.checkpoint_capacity Allocated length of checkpoints.
+ * @var Replay.states State bytes of all checkpoints, back to back.
+ * @var Replay.states_size Number of used state bytes.
+ * @var Replay.states_capacity Allocated length of states.
+ */
+typedef struct Replay {
+  uint16_t engine_version;
+  uint8_t game;
+  uint8_t mode;
+  uint64_t seed;
+  ReplayInput *inputs;
+  size_t count;
+  size_t capacity;
+  unsigned long steps;
+  uint64_t final_hash;
+  unsigned long checkpoint_interval;
+  ReplayCheckpoint *checkpoints;
+  size_t checkpoint_count;
+  size_t checkpoint_capacity;
+  uint8_t *states;
+  size_t states_size;
+  size_t states_capacity;
+} Replay;
+
+/**
+ * @brief Starts an empty recording.
+ * @param replay Pointer to the Replay structure.
+ * @param game Recorded game.
+ * @param mode Tetris piece randomizer, 0 for snake.
+ * @param seed Seed the game was created with.
+ */
+void replay_init(Replay *replay, ReplayGame game, int mode, uint64_t seed);
+
+/**
+ * @brief Frees the recorded inputs and checkpoints.
+ * @param replay Pointer to the Replay structure.
+ */
+void replay_free(Replay *replay);
+
+/**
+ * @brief Recorder hook: the engine took one step.
+ * @param replay Pointer to the Replay structure.
+ * @return true if the engine should store a checkpoint now.
+ */
+bool replay_step(Replay *replay);
+
+/**
+ * @brief Recorder hook: the engine received an input.
+ * @param replay Pointer to the Replay structure.
+ * @param action UserAction_t value or REPLAY_RESET.
+ * @param hold Hold flag passed with the input.
+ */
+void replay_input(Replay *replay, int action, bool hold);
+
+/**
+ * @brief Recorder hook: stores a checkpoint of the engine state at the
+ * current step, after every input recorded so far.
+ * @param replay Pointer to the Replay structure.
+ * @param state Engine state bytes.
+ * @param size Number of state bytes, at most REPLAY_CHECKPOINT_MAX.
+ */
+void replay_checkpoint(Replay *replay, const void *state, size_t size);
+
+/**
+ * @brief Finds the checkpoint to resume from when seeking.
+ * @param replay Pointer to the Replay structure.
+ * @param step Step to seek to.
+ * @return The last checkpoint taken at or before the step, NULL if there is
+ * none and the session has to be simulated from the seed.
+ */
+const ReplayCheckpoint *replay_find_checkpoint(const Replay *replay,
+                                               unsigned long step);
+
+/**
+ * @brief Returns the engine state bytes of a checkpoint.
+ * @param replay Pointer to the Replay structure.
+ * @param checkpoint Checkpoint of this replay.
+ * @return Pointer to checkpoint->size bytes.
+ */
+const uint8_t *replay_checkpoint_state(const Replay *replay,
+                                       const ReplayCheckpoint *checkpoint);
+
+/**
+ * @brief Writes the replay in the binary format.
+ * @param replay Pointer to the Replay structure.
+ * @param path Path of the file to write.
+ * @return true on success.
+ */
+bool replay_save(const Replay *replay, const char *path);
+
+/**
+ * @brief Reads a replay written by replay_save().
+ * @param replay Pointer to the Replay structure, initialized on success and
+ * left empty on failure.
+ * @param path Path of the file to read.
+ * @return true if the file is a well-formed replay of a known format.
+ */
+bool replay_load(Replay *replay, const char *path);
+
+/**
+ * @brief Folds bytes into an FNV-1a state hash.
+ * @param hash Hash so far, REPLAY_HASH_SEED to start.
+ * @param data Bytes to add.
+ * @param size Number of bytes.
+ * @return Updated hash.
+ */
+uint64_t replay_hash(uint64_t hash, const void *data, size_t size);
+
+/**
+ * @brief Appends a little-endian integer to an engine state buffer.
+ * @param out Where to write.
+ * @param value Value to write, truncated to the given size.
+ * @param bytes Number of bytes, 1 to 8.
+ * @return Pointer past the written bytes.
+ */
+uint8_t *replay_put(uint8_t *out, uint64_t value, int bytes);
+
+/**
+ * @brief Reads a little-endian integer written by replay_put().
+ * @param in Where to read.
+ * @param value Output value.
+ * @param bytes Number of bytes, 1 to 8.
+ * @return Pointer past the read bytes.
+ */
+const uint8_t *replay_get(const uint8_t *in, uint64_t *value, int bytes);
+
+#endif
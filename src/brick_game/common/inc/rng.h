@@ -0,0 +1,53 @@
+/**
+ * @file rng.h
+ * @brief Header file containing the seedable pseudo-random generator shared
+ * by the game engines.
+ *
+ * The generator is xoshiro256** seeded through splitmix64. Its whole state
+ * lives in the Rng structure, so every game owns an independent stream and
+ * games with the same seed replay the same sequence on any thread.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * @struct Rng
+ * @brief Structure representing the xoshiro256** state.
+ * @var Rng.s The four state words, never all zero.
+ */
+typedef struct Rng {
+  uint64_t s[4];
+} Rng;
+
+/**
+ * @brief Seeds the generator. Equal seeds give equal sequences.
+ * @param rng Pointer to the Rng structure.
+ * @param seed Any 64-bit value, zero included.
+ */
+void rng_seed(Rng *rng, uint64_t seed);
+
+/**
+ * @brief Returns the next 64 random bits.
+ * @param rng Pointer to the Rng structure.
+ * @return Uniformly distributed 64-bit value.
+ */
+uint64_t rng_next(Rng *rng);
+
+/**
+ * @brief Returns an unbiased random number below the bound.
+ * @param rng Pointer to the Rng structure.
+ * @param bound Exclusive upper limit, greater than zero.
+ * @return Uniformly distributed value in [0, bound).
+ */
+uint32_t rng_below(Rng *rng, uint32_t bound);
+
+/**
+ * @brief Returns a seed that differs between calls and program runs.
+ * @return Seed taken from the wall clock and a call counter.
+ */
+uint64_t rng_random_seed();
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file shared_session.h
+ * @brief Header file containing the shared-memory session through which
+ * other processes watch and control a running game.
+ *
+ * A game started with BRICKGAME_SHM=/name creates a POSIX shared-memory
+ * object of that name holding one SharedSession. The game thread snapshots
+ * every published Frame straight into it under a sequence lock: the
+ * sequence is odd while the frame is written, so a reader that sees the same even sequence
+ * before and after its copy has a consistent frame and never blocks the
+ * game. Commands travel the other way through a single-producer
+ * single-consumer ring of actions, the same scheme as InputQueue, with one
+ * controlling process as the producer and the game thread as the consumer.
+ * Both sides only use lock-free atomics, so nothing is serialized and no
+ * process waits on another.
+ */
+
+#ifndef SHARED_SESSION_H
+#define SHARED_SESSION_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "../../inc/defines.h"
+#include "frame_buffer.h"
+
+#define SHARED_SESSION_MAGIC 0x48534742u /**< "BGSH" in little endian. */
+#define SHARED_SESSION_VERSION 2 /**< Layout version of SharedSession. */
+#define SHARED_SESSION_COMMANDS \
+  64 /**< Capacity of the command ring, a power of two. */
+#define SHARED_SESSION_CACHE_LINE 64 /**< Cache line size used for padding. */
+#define SHARED_SESSION_POLL_US \
+  1000 /**< Longest time a command waits for the game thread. */
+#define SHARED_SESSION_READ_ATTEMPTS \
+  1000 /**< Reads tried before a frame counts as unreadable. */
+
+/**
+ * @brief Enumeration of the games a session can publish.
+ */
+typedef enum { SHARED_TETRIS, SHARED_SNAKE } SharedGame;
+
+/**
+ * @struct SharedCommand
+ * @brief Structure representing one action sent by a controlling process.
+ * @var SharedCommand.action UserAction_t value.
+ * @var SharedCommand.hold Whether the action key is held down.
+ */
+typedef struct SharedCommand {
+  uint8_t action;
+  uint8_t hold;
+} SharedCommand;
+
+/**
+ * @struct SharedSession
+ * @brief Structure representing the contents of the shared-memory object.
+ * @var SharedSession.magic SHARED_SESSION_MAGIC once the game set it up.
+ * @var SharedSession.version SHARED_SESSION_VERSION.
+ * @var SharedSession.size sizeof(SharedSession) of the game.
+ * @var SharedSession.game SharedGame of the game.
+ * @var SharedSession.token Random number telling this session apart from
+ * later ones of the same name.
+ * @var SharedSession.owner Process id of the game.
+ * @var SharedSession.sequence Sequence lock of frame, odd while it is
+ * written.
+ * @var SharedSession.frame Latest frame of the game.
+ * @var SharedSession.head Index of the next command to apply, written by the
+ * game.
+ * @var SharedSession.tail Index of the next free command slot, written by
+ * the controlling process.
+ * @var SharedSession.commands Ring buffer of commands.
+ */
+typedef struct SharedSession {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint32_t game;
+  uint64_t token;
+  uint32_t owner;
+  alignas(SHARED_SESSION_CACHE_LINE) std::atomic<uint32_t> sequence;
+  Frame frame;
+  alignas(SHARED_SESSION_CACHE_LINE) std::atomic<uint32_t> head;
+  alignas(SHARED_SESSION_CACHE_LINE) std::atomic<uint32_t> tail;
+  alignas(SHARED_SESSION_CACHE_LINE) SharedCommand
+      commands[SHARED_SESSION_COMMANDS];
+} SharedSession;
+
+/**
+ * @brief Creates the shared-memory object and maps an empty session.
+ *
+ * An existing object of the same name is only replaced if it is a session
+ * whose game is no longer running.
+ *
+ * @param name Object name, a slash followed by up to NAME_MAX characters.
+ * @param game Game the session publishes.
+ * @return Mapped session, NULL on failure or if a running game already
+ * uses the name.
+ */
+SharedSession *shared_session_create(const char *name, SharedGame game);
+
+/**
+ * @brief Unmaps a session made by shared_session_create() and removes its
+ * object, unless the name now belongs to another session.
+ * @param session Session to remove, may be NULL.
+ * @param name Name the session was created with.
+ */
+void shared_session_destroy(SharedSession *session, const char *name);
+
+/**
+ * @brief Maps the session of a running game.
+ * @param name Object name the game was started with.
+ * @return Mapped session, NULL if there is no valid session of that name.
+ */
+SharedSession *shared_session_open(const char *name);
+
+/**
+ * @brief Unmaps a session made by shared_session_open().
+ * @param session Session to unmap, may be NULL.
+ */
+void shared_session_close(SharedSession *session);
+
+/**
+ * @brief Starts writing a frame in place: marks the session frame as being
+ * written and returns it. Called only by the game, which must call
+ * shared_session_end() when the frame is complete.
+ * @param session Pointer to the SharedSession structure.
+ * @return The session frame to write.
+ */
+Frame *shared_session_begin(SharedSession *session);
+
+/**
+ * @brief Publishes the frame written since shared_session_begin().
+ * @param session Pointer to the SharedSession structure.
+ */
+void shared_session_end(SharedSession *session);
+
+/**
+ * @brief Copies a frame into the session. Called only by the game.
+ * @param session Pointer to the SharedSession structure.
+ * @param frame Frame to publish.
+ */
+void shared_session_publish(SharedSession *session, const Frame *frame);
+
+/**
+ * @brief Copies the latest consistent frame out of the session.
+ * @param session Pointer to the SharedSession structure.
+ * @param frame Receives the frame.
+ * @return false if the game has not published a frame yet, or if no
+ * consistent frame was read in SHARED_SESSION_READ_ATTEMPTS tries, as when
+ * the game died while writing one.
+ */
+bool shared_session_read(const SharedSession *session, Frame *frame);
+
+/**
+ * @brief Sends an action to the game. Called only by the controlling
+ * process.
+ * @param session Pointer to the SharedSession structure.
+ * @param action User action.
+ * @param hold Whether the action key is held down.
+ * @return false if the ring is full and the action was not sent.
+ */
+bool shared_session_push(SharedSession *session, UserAction_t action,
+                         bool hold);
+
+/**
+ * @brief Checks whether actions are waiting for the game.
+ * @param session Pointer to the SharedSession structure.
+ * @return true if the ring is not empty.
+ */
+bool shared_session_pending(const SharedSession *session);
+
+/**
+ * @brief Takes the oldest action sent to the game. Called only by the game.
+ *
+ * The controlling process is not trusted, so values that are not a
+ * UserAction_t are skipped.
+ *
+ * @param session Pointer to the SharedSession structure.
+ * @param command Receives the action.
+ * @return false if no valid action is waiting.
+ */
+bool shared_session_pop(SharedSession *session, SharedCommand *command);
+
+#endif
@@ -0,0 +1,28 @@
+#include "./inc/input_queue.h"
+
+void input_queue_init(InputQueue *queue) {
+  queue->head.store(0, std::memory_order_relaxed);
+  queue->tail.store(0, std::memory_order_relaxed);
+}
+
+bool input_queue_push(InputQueue *queue, const InputEvent *event) {
+  unsigned tail = queue->tail.load(std::memory_order_relaxed);
+  if (tail - queue->head.load(std::memory_order_acquire) == INPUT_QUEUE_SIZE)
+    return false;
+  queue->events[tail & (INPUT_QUEUE_SIZE - 1)] = *event;
+  queue->tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+bool input_queue_pop(InputQueue *queue, InputEvent *event) {
+  unsigned head = queue->head.load(std::memory_order_relaxed);
+  if (head == queue->tail.load(std::memory_order_acquire)) return false;
+  *event = queue->events[head & (INPUT_QUEUE_SIZE - 1)];
+  queue->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+bool input_queue_empty(const InputQueue *queue) {
+  return queue->head.load(std::memory_order_acquire) ==
+         queue->tail.load(std::memory_order_acquire);
+}
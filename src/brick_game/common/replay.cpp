@@ -0,0 +1,278 @@
+#include "./inc/replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char replay_magic[4] = {'B', 'G', 'R', 'P'};
+
+static bool write_bytes(FILE *file, const void *data, size_t size) {
+  return fwrite(data, 1, size, file) == size;
+}
+
+static bool write_uint(FILE *file, uint64_t value, int bytes) {
+  uint8_t buffer[8];
+  replay_put(buffer, value, bytes);
+  return write_bytes(file, buffer, bytes);
+}
+
+static bool write_varint(FILE *file, uint64_t value) {
+  uint8_t buffer[10];
+  int size = 0;
+  do {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    buffer[size++] = value ? (uint8_t)(byte | 0x80) : byte;
+  } while (value);
+  return write_bytes(file, buffer, size);
+}
+
+static bool read_uint(FILE *file, uint64_t *value, int bytes) {
+  uint8_t buffer[8];
+  if (fread(buffer, 1, bytes, file) != (size_t)bytes) return false;
+  replay_get(buffer, value, bytes);
+  return true;
+}
+
+static bool read_varint(FILE *file, uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = fgetc(file);
+    if (byte == EOF) return false;
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static bool reserve(void **data, size_t *capacity, size_t needed,
+                    size_t item_size, size_t initial) {
+  if (needed <= *capacity) return true;
+  size_t grown = *capacity ? *capacity * 2 : initial;
+  if (grown < needed) grown = needed;
+  void *resized = realloc(*data, grown * item_size);
+  if (resized == NULL) return false;
+  *data = resized;
+  *capacity = grown;
+  return true;
+}
+
+static bool append_checkpoint(Replay *replay, unsigned long step,
+                              size_t input, const void *state, size_t size) {
+  if (size > REPLAY_CHECKPOINT_MAX ||
+      !reserve((void **)&replay->checkpoints, &replay->checkpoint_capacity,
+               replay->checkpoint_count + 1, sizeof(ReplayCheckpoint), 64) ||
+      !reserve((void **)&replay->states, &replay->states_capacity,
+               replay->states_size + size, 1, 16384)) {
+    return false;
+  }
+  ReplayCheckpoint *checkpoint =
+      &replay->checkpoints[replay->checkpoint_count++];
+  checkpoint->step = step;
+  checkpoint->input = input;
+  checkpoint->offset = replay->states_size;
+  checkpoint->size = size;
+  memcpy(replay->states + replay->states_size, state, size);
+  replay->states_size += size;
+  return true;
+}
+
+static bool write_checkpoints(FILE *file, const Replay *replay) {
+  bool ok = write_varint(file, replay->checkpoint_interval) &&
+            write_varint(file, replay->checkpoint_count);
+  unsigned long step = 0;
+  size_t input = 0;
+  for (size_t i = 0; ok && i < replay->checkpoint_count; i++) {
+    const ReplayCheckpoint *checkpoint = &replay->checkpoints[i];
+    ok = write_varint(file, checkpoint->step - step) &&
+         write_varint(file, checkpoint->input - input) &&
+         write_varint(file, checkpoint->size) &&
+         write_bytes(file, replay_checkpoint_state(replay, checkpoint),
+                     checkpoint->size);
+    step = checkpoint->step;
+    input = checkpoint->input;
+  }
+  return ok;
+}
+
+static bool read_checkpoints(FILE *file, Replay *replay) {
+  uint64_t interval = 0, count = 0;
+  bool ok = read_varint(file, &interval) && read_varint(file, &count);
+  if (ok) replay->checkpoint_interval = (unsigned long)interval;
+  uint64_t step = 0, input = 0;
+  uint8_t state[REPLAY_CHECKPOINT_MAX];
+  for (uint64_t i = 0; ok && i < count; i++) {
+    uint64_t step_delta = 0, input_delta = 0, size = 0;
+    ok = read_varint(file, &step_delta) && read_varint(file, &input_delta) &&
+         read_varint(file, &size) && size <= REPLAY_CHECKPOINT_MAX &&
+         fread(state, 1, size, file) == size;
+    step += step_delta;
+    input += input_delta;
+    ok = ok && step <= replay->steps && input <= replay->count;
+    ok = ok && append_checkpoint(replay, (unsigned long)step, (size_t)input,
+                                 state, (size_t)size);
+  }
+  return ok;
+}
+
+void replay_init(Replay *replay, ReplayGame game, int mode, uint64_t seed) {
+  replay->engine_version = REPLAY_ENGINE_VERSION;
+  replay->game = (uint8_t)game;
+  replay->mode = (uint8_t)mode;
+  replay->seed = seed;
+  replay->inputs = NULL;
+  replay->count = 0;
+  replay->capacity = 0;
+  replay->steps = 0;
+  replay->final_hash = 0;
+  replay->checkpoint_interval = REPLAY_CHECKPOINT_INTERVAL;
+  replay->checkpoints = NULL;
+  replay->checkpoint_count = 0;
+  replay->checkpoint_capacity = 0;
+  replay->states = NULL;
+  replay->states_size = 0;
+  replay->states_capacity = 0;
+}
+
+void replay_free(Replay *replay) {
+  free(replay->inputs);
+  replay->inputs = NULL;
+  replay->count = 0;
+  replay->capacity = 0;
+  free(replay->checkpoints);
+  replay->checkpoints = NULL;
+  replay->checkpoint_count = 0;
+  replay->checkpoint_capacity = 0;
+  free(replay->states);
+  replay->states = NULL;
+  replay->states_size = 0;
+  replay->states_capacity = 0;
+}
+
+bool replay_step(Replay *replay) {
+  replay->steps++;
+  return replay->checkpoint_interval != 0 &&
+         replay->steps % replay->checkpoint_interval == 0;
+}
+
+void replay_input(Replay *replay, int action, bool hold) {
+  if (!reserve((void **)&replay->inputs, &replay->capacity, replay->count + 1,
+               sizeof(ReplayInput), 256)) {
+    return;
+  }
+  ReplayInput *input = &replay->inputs[replay->count++];
+  input->step = replay->steps;
+  input->action = (uint8_t)action;
+  input->hold = hold;
+}
+
+void replay_checkpoint(Replay *replay, const void *state, size_t size) {
+  append_checkpoint(replay, replay->steps, replay->count, state, size);
+}
+
+const ReplayCheckpoint *replay_find_checkpoint(const Replay *replay,
+                                               unsigned long step) {
+  size_t low = 0, high = replay->checkpoint_count;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (replay->checkpoints[middle].step <= step) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low ? &replay->checkpoints[low - 1] : NULL;
+}
+
+const uint8_t *replay_checkpoint_state(const Replay *replay,
+                                       const ReplayCheckpoint *checkpoint) {
+  return replay->states + checkpoint->offset;
+}
+
+bool replay_save(const Replay *replay, const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) return false;
+
+  bool ok = write_bytes(file, replay_magic, sizeof(replay_magic)) &&
+            write_uint(file, REPLAY_FORMAT_VERSION, 2) &&
+            write_uint(file, replay->engine_version, 2) &&
+            write_uint(file, replay->game, 1) &&
+            write_uint(file, replay->mode, 1) &&
+            write_uint(file, replay->seed, 8) &&
+            write_uint(file, replay->count, 4);
+  unsigned long step = 0;
+  for (size_t i = 0; ok && i < replay->count; i++) {
+    const ReplayInput *input = &replay->inputs[i];
+    ok = write_varint(file, input->step - step) &&
+         write_uint(file, input->action | (input->hold ? REPLAY_HOLD : 0), 1);
+    step = input->step;
+  }
+  ok = ok && write_varint(file, replay->steps - step) &&
+       write_uint(file, replay->final_hash, 8) &&
+       write_checkpoints(file, replay);
+
+  return fclose(file) == 0 && ok;
+}
+
+bool replay_load(Replay *replay, const char *path) {
+  replay_init(replay, REPLAY_TETRIS, 0, 0);
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) return false;
+
+  char magic[4];
+  uint64_t format = 0, engine = 0, game = 0, mode = 0, seed = 0, count = 0;
+  bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+            memcmp(magic, replay_magic, sizeof(magic)) == 0 &&
+            read_uint(file, &format, 2) && format >= 1 &&
+            format <= REPLAY_FORMAT_VERSION &&
+            read_uint(file, &engine, 2) && read_uint(file, &game, 1) &&
+            game <= REPLAY_SNAKE && read_uint(file, &mode, 1) &&
+            read_uint(file, &seed, 8) && read_uint(file, &count, 4);
+  if (ok) {
+    replay_init(replay, (ReplayGame)game, (int)mode, seed);
+    replay->engine_version = (uint16_t)engine;
+  }
+
+  for (uint64_t i = 0; ok && i < count; i++) {
+    uint64_t delta = 0, packed = 0;
+    ok = read_varint(file, &delta) && read_uint(file, &packed, 1);
+    if (ok) {
+      replay->steps += delta;
+      replay_input(replay, packed & ~REPLAY_HOLD, packed & REPLAY_HOLD);
+      ok = replay->count == i + 1;
+    }
+  }
+  uint64_t delta = 0;
+  ok = ok && read_varint(file, &delta) &&
+       read_uint(file, &replay->final_hash, 8);
+  if (ok) replay->steps += delta;
+  if (format == 1) {
+    replay->checkpoint_interval = 0;
+  } else {
+    ok = ok && read_checkpoints(file, replay);
+  }
+
+  fclose(file);
+  if (!ok) replay_free(replay);
+  return ok;
+}
+
+uint64_t replay_hash(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+uint8_t *replay_put(uint8_t *out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) *out++ = (uint8_t)(value >> (8 * i));
+  return out;
+}
+
+const uint8_t *replay_get(const uint8_t *in, uint64_t *value, int bytes) {
+  *value = 0;
+  for (int i = 0; i < bytes; i++) *value |= (uint64_t)*in++ << (8 * i);
+  return in;
+}
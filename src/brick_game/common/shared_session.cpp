@@ -0,0 +1,198 @@
+#include "./inc/shared_session.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+#include "./inc/rng.h"
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared atomics must not depend on a process-local lock");
+
+static SharedSession *map_session(int fd, int protection) {
+  void *memory =
+      mmap(NULL, sizeof(SharedSession), protection, MAP_SHARED, fd, 0);
+  close(fd);
+  return memory == MAP_FAILED ? NULL : (SharedSession *)memory;
+}
+
+/**
+ * @brief Maps the object of a name read-only if it holds a session of this
+ * layout.
+ */
+static const SharedSession *peek_session(const char *name) {
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) return NULL;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SharedSession)) {
+    close(fd);
+    return NULL;
+  }
+  SharedSession *session = map_session(fd, PROT_READ);
+  if (session == NULL) return NULL;
+  bool valid = session->magic == SHARED_SESSION_MAGIC;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || session->version != SHARED_SESSION_VERSION ||
+      session->size != sizeof(SharedSession)) {
+    munmap(session, sizeof(SharedSession));
+    session = NULL;
+  }
+  return session;
+}
+
+/**
+ * @brief Removes the object of a name if it is a session left behind by a
+ * game that no longer runs. Objects of live games and objects that are not
+ * sessions are kept.
+ * @return true if the object was removed.
+ */
+static bool remove_stale(const char *name) {
+  const SharedSession *old = peek_session(name);
+  if (old == NULL) return false;
+  bool stale = kill((pid_t)old->owner, 0) != 0 && errno == ESRCH;
+  munmap((void *)old, sizeof(SharedSession));
+  return stale && shm_unlink(name) == 0;
+}
+
+SharedSession *shared_session_create(const char *name, SharedGame game) {
+  const int flags = O_CREAT | O_EXCL | O_RDWR;
+  int fd = shm_open(name, flags, S_IRUSR | S_IWUSR);
+  if (fd < 0 && errno == EEXIST && remove_stale(name)) {
+    fd = shm_open(name, flags, S_IRUSR | S_IWUSR);
+  }
+  if (fd < 0) return NULL;
+  if (ftruncate(fd, sizeof(SharedSession)) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return NULL;
+  }
+  SharedSession *session = map_session(fd, PROT_READ | PROT_WRITE);
+  if (session == NULL) {
+    shm_unlink(name);
+    return NULL;
+  }
+
+  memset((void *)session, 0, sizeof(SharedSession));
+  new (&session->sequence) std::atomic<uint32_t>(0);
+  new (&session->head) std::atomic<uint32_t>(0);
+  new (&session->tail) std::atomic<uint32_t>(0);
+  session->version = SHARED_SESSION_VERSION;
+  session->size = sizeof(SharedSession);
+  session->game = game;
+  session->owner = (uint32_t)getpid();
+  session->token = rng_random_seed();
+  // Readers check the magic last, so they never see a half set up session.
+  std::atomic_thread_fence(std::memory_order_release);
+  session->magic = SHARED_SESSION_MAGIC;
+  return session;
+}
+
+void shared_session_destroy(SharedSession *session, const char *name) {
+  if (session == NULL) return;
+  // The name may have been taken over since, so only our own object goes.
+  const SharedSession *named = peek_session(name);
+  bool ours = named != NULL && named->token == session->token &&
+              session->owner == (uint32_t)getpid();
+  if (named != NULL) munmap((void *)named, sizeof(SharedSession));
+  munmap(session, sizeof(SharedSession));
+  if (ours) shm_unlink(name);
+}
+
+SharedSession *shared_session_open(const char *name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) return NULL;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SharedSession)) {
+    close(fd);
+    return NULL;
+  }
+  SharedSession *session = map_session(fd, PROT_READ | PROT_WRITE);
+  if (session == NULL) return NULL;
+  bool valid = session->magic == SHARED_SESSION_MAGIC;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  valid = valid && session->version == SHARED_SESSION_VERSION &&
+          session->size == sizeof(SharedSession);
+  if (!valid) {
+    shared_session_close(session);
+    session = NULL;
+  }
+  return session;
+}
+
+void shared_session_close(SharedSession *session) {
+  if (session != NULL) munmap(session, sizeof(SharedSession));
+}
+
+Frame *shared_session_begin(SharedSession *session) {
+  uint32_t sequence = session->sequence.load(std::memory_order_relaxed);
+  session->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return &session->frame;
+}
+
+void shared_session_end(SharedSession *session) {
+  uint32_t sequence = session->sequence.load(std::memory_order_relaxed);
+  session->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+void shared_session_publish(SharedSession *session, const Frame *frame) {
+  memcpy(shared_session_begin(session), frame, sizeof(Frame));
+  shared_session_end(session);
+}
+
+bool shared_session_read(const SharedSession *session, Frame *frame) {
+  for (int attempt = 0; attempt < SHARED_SESSION_READ_ATTEMPTS; attempt++) {
+    uint32_t before = session->sequence.load(std::memory_order_acquire);
+    if ((before & 1u) == 0) {
+      memcpy(frame, &session->frame, sizeof(Frame));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint32_t after = session->sequence.load(std::memory_order_relaxed);
+      if (before == after) return before != 0;
+    }
+    // Let a writer that was interrupted mid-frame finish it.
+    sched_yield();
+  }
+  return false;
+}
+
+bool shared_session_push(SharedSession *session, UserAction_t action,
+                         bool hold) {
+  uint32_t tail = session->tail.load(std::memory_order_relaxed);
+  if (tail - session->head.load(std::memory_order_acquire) ==
+      SHARED_SESSION_COMMANDS) {
+    return false;
+  }
+  SharedCommand *command =
+      &session->commands[tail & (SHARED_SESSION_COMMANDS - 1)];
+  command->action = (uint8_t)action;
+  command->hold = hold;
+  session->tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+bool shared_session_pending(const SharedSession *session) {
+  return session->head.load(std::memory_order_acquire) !=
+         session->tail.load(std::memory_order_acquire);
+}
+
+bool shared_session_pop(SharedSession *session, SharedCommand *command) {
+  uint32_t head = session->head.load(std::memory_order_relaxed);
+  uint32_t tail = session->tail.load(std::memory_order_acquire);
+  // A tail more than a ring ahead can only come from a broken producer.
+  if (tail - head > SHARED_SESSION_COMMANDS) head = tail;
+  bool found = false;
+  while (!found && head != tail) {
+    *command = session->commands[head & (SHARED_SESSION_COMMANDS - 1)];
+    head++;
+    found = command->action <= IDLE;
+  }
+  session->head.store(head, std::memory_order_release);
+  return found;
+}
@@ -9,6 +9,20 @@
 #include <memory>
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
+
+#define FIGURE_SIZE 5   /**< Size of tetris figure. */
+#define FIELD_STRIDE 16 /**< Bytes per field row, padding included. */
+#define FIELD_ALIGN 64  /**< Alignment of the field buffer, one cache line. */
+
+/**
+ * @brief One field row: FIELD_WIDTH cells padded to FIELD_STRIDE bytes.
+ *
+ * A field is a single contiguous array of FIELD_HEIGHT rows, so
+ * field[row][col] indexes it like the old array of row pointers while the
+ * whole field can be copied with one memcpy of FIELD_BYTES.
+ */
+typedef uint8_t FieldRow[FIELD_STRIDE];
 
 /**
  * @struct Figure
@@ -16,19 +30,24 @@
  * @var Figure.x x-coordinate of the figure's position.
  * @var Figure.y y-coordinate of the figure's position.
  * @var Figure.figure_num Number representing the type of figure.
- * @var Figure.figure 2D array representing the shape of the figure.
+ * @var Figure.rotation Index of the current rotation of the figure.
+ * @var Figure.figure Cells of the figure shape, stored inline.
  */
 typedef struct Figure {
   int x;
   int y;
   int figure_num;
-  int **figure;
+  int rotation;
+  int figure[FIGURE_SIZE][FIGURE_SIZE];
 } Figure;
 
+struct PieceGenerator;
+struct Replay;
+
 /**
  * @struct GameInfo_t
  * @brief Structure representing the game state and information.
- * @var GameInfo_t.field 2D array representing the game field.
+ * @var GameInfo_t.field Contiguous rows of the game field.
  * @var GameInfo_t.next_figure Pointer to the next figure.
  * @var GameInfo_t.score Current score.
  * @var GameInfo_t.high_score Highest score achieved.
@@ -39,9 +58,17 @@ typedef struct Figure {
  * @var GameInfo_t.status Current status of the game.
  * @var GameInfo_t.action Current action being performed.
  * @var GameInfo_t.ticks_left Number of ticks left for the current action.
+ * @var GameInfo_t.changed_cells Number of field cells changed since the
+ * previous frame, -1 if the engine does not track changes.
+ * @var GameInfo_t.pieces Storage that figure and next_figure point into, so
+ * spawning a figure swaps the two slots instead of allocating.
+ * @var GameInfo_t.generator Randomizer dealing the figures of this game.
+ * @var GameInfo_t.persist_score Whether the high score is saved to disk.
+ * @var GameInfo_t.recorder Replay receiving the inputs and steps of this
+ * game, NULL when not recording.
  */
 typedef struct {
-  int **field;
+  FieldRow *field;
   Figure *next_figure;
   int score;
   int high_score;
@@ -53,6 +80,12 @@ typedef struct {
   int status;
   int action;
   int ticks_left;
+  int changed_cells;
+
+  Figure pieces[2];
+  struct PieceGenerator *generator;
+  int persist_score;
+  struct Replay *recorder;
 } GameInfo_t;
 
 typedef enum {
@@ -70,15 +103,18 @@ typedef enum {
 typedef enum { Running, Paused, GameOver, Exit, Win } GameState;
 
 #define TICKS_START 30 /**< Initial number of ticks. */
+#define TICK_DURATION 33000000 /**< Duration of a tick at speed 0, in ns. */
 
-#define FIGURE_SIZE 5   /**< Size of tetris figure. */
 #define FIGURES_COUNT 7 /**< Total number of tetris figures. */
+#define FIGURE_ROTATIONS 4 /**< Number of rotations of each figure. */
 
 #define WIDTH_FACTOR 2 /**< Factor used to calculate width of game field.*/
 
 #define FIELD_WIDTH 10  /**< Width of the game field. */
 #define FIELD_HEIGHT 20 /**< Height of the game field. */
 #define FIELD_BORDERS 2 /**< Number of border lines around the game field. */
+#define FIELD_BYTES \
+  (FIELD_HEIGHT * FIELD_STRIDE) /**< Size of the whole field buffer. */
 
 #define FIELD_START_X 17 /**< Starting x-coordinate of the game field. */
 #define FIELD_START_Y 2  /**< Starting y-coordinate of the game field. */
@@ -5,7 +5,7 @@ namespace s21 {
 GameController::GameController(GameModel *game_model) : game_model_(game_model) {}
 
 void GameController::userInput(UserAction_t action, bool hold) {
-  (void)hold;
+  game_model_->RecordInput(action, hold);
   switch (action) {
   case Start:
     game_model_->SetGameState(Running);
@@ -39,4 +39,48 @@ void GameController::userInput(UserAction_t action, bool hold) {
   }
 }
 
+/**
+ * @brief Заново проходит записанный ввод, начиная с заданного, до шага.
+ *
+ * @param replay Записанная игра.
+ * @param model Модель в состоянии после done шагов.
+ * @param input Номер первого применяемого ввода.
+ * @param done Количество уже сделанных шагов.
+ * @param step Шаг, на котором нужно остановиться.
+ */
+static void RunInputs(const Replay *replay, GameModel *model, size_t input,
+                      unsigned long done, unsigned long step) {
+  GameController controller(model);
+  for (size_t i = input; i <= replay->count; ++i) {
+    bool last = i == replay->count || replay->inputs[i].step > step;
+    unsigned long until = last ? step : replay->inputs[i].step;
+    for (; done < until; ++done) {
+      model->UpdateGame();
+    }
+    if (last) {
+      break;
+    }
+    controller.userInput(static_cast<UserAction_t>(replay->inputs[i].action),
+                         replay->inputs[i].hold);
+  }
+}
+
+uint64_t ReplaySnake(const Replay *replay) {
+  GameModel model(false, replay->seed);
+  RunInputs(replay, &model, 0, 0, replay->steps);
+  return model.StateHash();
+}
+
+void SeekSnake(const Replay *replay, unsigned long step, GameModel *model) {
+  step = std::min(step, replay->steps);
+  const ReplayCheckpoint *checkpoint = replay_find_checkpoint(replay, step);
+  if (checkpoint != nullptr &&
+      model->Restore(replay_checkpoint_state(replay, checkpoint),
+                     checkpoint->size)) {
+    RunInputs(replay, model, checkpoint->input, checkpoint->step, step);
+  } else {
+    RunInputs(replay, model, 0, 0, step);
+  }
+}
+
 } // namespace s21
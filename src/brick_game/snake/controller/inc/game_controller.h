@@ -17,6 +17,30 @@ class GameController {
   void userInput(UserAction_t action, bool hold);
 };
 
+/**
+ * @brief Проигрывает записанную игру в змейку с начала с максимальной
+ * скоростью, не используя контрольные точки.
+ *
+ * @param replay Записанная игра.
+ * @return Хеш конечного состояния для сравнения с replay->final_hash.
+ */
+uint64_t ReplaySnake(const Replay *replay);
+
+/**
+ * @brief Восстанавливает состояние записанной игры на заданном шаге.
+ *
+ * Загружает последнюю контрольную точку не позже шага и заново проходит
+ * только ввод после неё, поэтому переход в конец длинной записи стоит не
+ * больше одного интервала контрольных точек.
+ *
+ * @param replay Записанная игра.
+ * @param step Шаг, к которому нужно перейти, не больше replay->steps. Ввод,
+ * записанный на этом шаге, применяется.
+ * @param model Модель, только что созданная как GameModel(false,
+ * replay->seed).
+ */
+void SeekSnake(const Replay *replay, unsigned long step, GameModel *model);
+
 }  // namespace s21
 
 #endif
@@ -3,28 +3,35 @@
 
 namespace s21 {
 
-Apple::Apple()
-    : position_(0, 0),
-      generator_(std::mt19937(std::random_device{}())) {}
+Apple::Apple() : Apple(rng_random_seed()) {}
+
+Apple::Apple(uint64_t seed) : position_(0, 0) { rng_seed(&generator_, seed); }
+
+void Apple::SpawnApple(const FreeCells &free_cells) {
+  if (free_cells.Size() == 0) {
+    return;
+  }
+  position_ = free_cells.At(static_cast<int>(
+      rng_below(&generator_, static_cast<uint32_t>(free_cells.Size()))));
+}
 
 void Apple::SpawnApple(const std::vector<Position> &occupied_position) {
-  std::uniform_int_distribution<int> dist_x(0, FIELD_WIDTH - 1);
-  std::uniform_int_distribution<int> dist_y(0, FIELD_HEIGHT - 1);
-
-  while (true) {
-    int x = dist_x(generator_);
-    int y = dist_y(generator_);
-    position_ = Position(x, y);
-
-    if (!std::any_of(occupied_position.begin(), occupied_position.end(),
-                     [&](const Position& pos) { return position_ == pos; })) {
-      break;
-    }
+  FreeCells free_cells;
+  for (const auto &pos : occupied_position) {
+    free_cells.Occupy(pos);
   }
+  SpawnApple(free_cells);
 }
 
 const Position& Apple::GetPosition() const {
   return position_;
 }
 
+const Rng &Apple::GetGenerator() const { return generator_; }
+
+void Apple::Restore(const Position &position, const Rng &generator) {
+  position_ = position;
+  generator_ = generator;
+}
+
 } // namespace s21
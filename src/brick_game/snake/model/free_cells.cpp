@@ -0,0 +1,87 @@
+#include "inc/free_cells.h"
+
+#include <utility>
+
+namespace s21 {
+
+FreeCells::FreeCells() { Reset(); }
+
+void FreeCells::Reset() {
+  for (int i = 0; i < kCellsCount; ++i) {
+    cells_[i] = i;
+    index_[i] = i;
+  }
+  size_ = kCellsCount;
+}
+
+void FreeCells::Occupy(const Position &position) {
+  int id = CellId(position);
+  if (id < 0 || index_[id] >= size_) {
+    return;
+  }
+  int last = cells_[size_ - 1];
+  std::swap(cells_[index_[id]], cells_[size_ - 1]);
+  index_[last] = index_[id];
+  index_[id] = size_ - 1;
+  --size_;
+}
+
+void FreeCells::Release(const Position &position) {
+  int id = CellId(position);
+  if (id < 0 || index_[id] < size_) {
+    return;
+  }
+  int first_busy = cells_[size_];
+  std::swap(cells_[index_[id]], cells_[size_]);
+  index_[first_busy] = index_[id];
+  index_[id] = size_;
+  ++size_;
+}
+
+bool FreeCells::IsFree(const Position &position) const {
+  int id = CellId(position);
+  return id >= 0 && index_[id] < size_;
+}
+
+int FreeCells::Size() const { return size_; }
+
+Position FreeCells::At(int index) const {
+  int id = cells_[index];
+  return Position(id % FIELD_WIDTH, id / FIELD_WIDTH);
+}
+
+void FreeCells::Save(uint8_t *cells) const {
+  for (int i = 0; i < kCellsCount; ++i) {
+    cells[i] = static_cast<uint8_t>(cells_[i]);
+  }
+}
+
+bool FreeCells::Restore(const uint8_t *cells, int size) {
+  std::array<int, kCellsCount> index;
+  index.fill(-1);
+  for (int i = 0; i < kCellsCount; ++i) {
+    if (cells[i] >= kCellsCount || index[cells[i]] >= 0) {
+      return false;
+    }
+    index[cells[i]] = i;
+  }
+  if (size < 0 || size > kCellsCount) {
+    return false;
+  }
+  for (int i = 0; i < kCellsCount; ++i) {
+    cells_[i] = cells[i];
+  }
+  index_ = index;
+  size_ = size;
+  return true;
+}
+
+int FreeCells::CellId(const Position &position) {
+  if (position.x < 0 || position.x >= FIELD_WIDTH || position.y < 0 ||
+      position.y >= FIELD_HEIGHT) {
+    return -1;
+  }
+  return position.y * FIELD_WIDTH + position.x;
+}
+
+}  // namespace s21
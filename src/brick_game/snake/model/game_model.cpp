@@ -2,78 +2,149 @@
 
 namespace s21 {
 
-GameModel::GameModel()
-    : snake_(), apple_(), score_(0), high_score_(0), level_(1),
+GameModel::GameModel() : GameModel(true) {}
+
+GameModel::GameModel(bool persist_high_score)
+    : GameModel(persist_high_score, rng_random_seed()) {}
+
+GameModel::GameModel(bool persist_high_score, uint64_t seed)
+    : snake_(), apple_(seed), score_(0), high_score_(0), level_(1),
       speed_(BASE_SPEED_S), interval_(BASE_SPEED_S),
-      original_interval_(BASE_SPEED_S), running_(false),
-      speed_up_active_(false), state_(Paused) {
-  apple_.SpawnApple(snake_.GetOccupiedPositon());
+      original_interval_(BASE_SPEED_S), speed_up_active_(false),
+      state_(Paused), persist_high_score_(persist_high_score), seed_(seed),
+      recorder_(nullptr), full_repaint_(true) {
+  game_clock_init(&clock_, BASE_SPEED_S * 1000LL, kMaxCatchUpSteps);
+  touched_cells_.reserve(FIELD_WIDTH * FIELD_HEIGHT);
+  dirty_cells_.reserve(FIELD_WIDTH * FIELD_HEIGHT);
+  SyncFreeCells();
+  apple_.SpawnApple(free_cells_);
   LoadHighScore();
   SetGameState(Paused);
   InitializeField();
 }
 
-GameModel::~GameModel() { ClearField(); }
+GameModel::~GameModel() {}
 
 GameInfo_t GameModel::UpdateCurrentState() {
-  if (state_ == Running && IsTimeToUpdate()) {
-    UpdateGame();
-  }
-
-  for (int i = 0; i < FIELD_HEIGHT; ++i) {
-    std::memset(field_[i], 0, FIELD_WIDTH * sizeof(int));
-  }
+  Advance();
+  return GetCurrentState();
+}
 
-  for (const auto &segment : snake_.GetBody()) {
-    if (CheckIsOnField(segment.position)) {
-      field_[segment.position.y][segment.position.x] = 3;
-    }
+void GameModel::Advance() {
+  while (state_ == Running && IsTimeToUpdate()) {
+    UpdateGame();
   }
+}
 
-  Position apple_pos = apple_.GetPosition();
-  field_[apple_pos.y][apple_pos.x] = 2;
+GameInfo_t GameModel::GetCurrentState() {
+  RepaintCells();
 
   GameInfo_t game_info;
-  game_info.field = field_.get();
+  game_info.field = field_;
   game_info.score = score_;
   game_info.high_score = high_score_;
   game_info.level = level_;
   game_info.speed = speed_;
   game_info.pause = state_ == Paused ? 1 : 0;
+  game_info.changed_cells = static_cast<int>(dirty_cells_.size());
 
   return game_info;
 }
 
-GameState GameModel::GetGameState() const { return state_; }
+void GameModel::Snapshot(Frame *frame) {
+  RepaintCells();
+  std::memcpy(frame->field, field_, FIELD_BYTES);
+  for (auto &row : frame->next) {
+    for (auto &cell : row) {
+      cell = 0;
+    }
+  }
+  frame->score = score_;
+  frame->high_score = high_score_;
+  frame->level = level_;
+  frame->speed = speed_;
+  frame->pause = state_ == Paused ? 1 : 0;
+  frame->state = state_;
+}
 
-void GameModel::InitializeField() {
-  field_ = std::make_unique<int *[]>(FIELD_HEIGHT);
-  for (int i = 0; i < FIELD_HEIGHT; ++i) {
-    field_[i] = new int[FIELD_WIDTH];
-    std::memset(field_[i], 0, FIELD_WIDTH * sizeof(int));
+const std::vector<Position> &GameModel::GetDirtyCells() const {
+  return dirty_cells_;
+}
+
+void GameModel::TouchCell(const Position &position) {
+  if (full_repaint_) {
+    return;
+  }
+  if (touched_cells_.size() >= FIELD_WIDTH * FIELD_HEIGHT) {
+    full_repaint_ = true;
+    touched_cells_.clear();
+    return;
   }
+  touched_cells_.push_back(position);
 }
 
-void GameModel::ClearField() {
-  if (field_) {
-    for (int i = 0; i < FIELD_HEIGHT; ++i) {
-      delete[] field_[i];
+int GameModel::CellValue(const Position &position) const {
+  if (position == apple_.GetPosition()) {
+    return 2;
+  }
+  return snake_.IsOccupied(position) ? 3 : 0;
+}
+
+void GameModel::RepaintCells() {
+  dirty_cells_.clear();
+  if (full_repaint_) {
+    for (int y = 0; y < FIELD_HEIGHT; ++y) {
+      for (int x = 0; x < FIELD_WIDTH; ++x) {
+        field_[y][x] = static_cast<uint8_t>(CellValue(Position(x, y)));
+        dirty_cells_.emplace_back(x, y);
+      }
+    }
+    full_repaint_ = false;
+  } else {
+    for (const auto &cell : touched_cells_) {
+      if (!CheckIsOnField(cell)) {
+        continue;
+      }
+      uint8_t value = static_cast<uint8_t>(CellValue(cell));
+      if (field_[cell.y][cell.x] != value) {
+        field_[cell.y][cell.x] = value;
+        dirty_cells_.push_back(cell);
+      }
     }
-    field_.reset();
   }
+  touched_cells_.clear();
+}
+
+GameState GameModel::GetGameState() const { return state_; }
+
+void GameModel::InitializeField() {
+  ClearField();
+  full_repaint_ = true;
 }
 
+void GameModel::ClearField() { std::memset(field_, 0, FIELD_BYTES); }
+
 void GameModel::ResetGame() {
   snake_ = Snake();
-  apple_.SpawnApple(snake_.GetOccupiedPositon());
+  SyncFreeCells();
+  apple_.SpawnApple(free_cells_);
   Reset();
   speed_ = BASE_SPEED_S;
   interval_ = BASE_SPEED_S;
-  running_ = false;
+  game_clock_stop(&clock_);
+  SyncClockStep();
   speed_up_active_ = false;
   state_ = GameOver;
-  ClearField();
-  InitializeField();
+  full_repaint_ = true;
+  touched_cells_.clear();
+}
+
+void GameModel::Restart(uint64_t seed) {
+  seed_ = seed;
+  apple_ = Apple(seed);
+  original_interval_ = BASE_SPEED_S;
+  ResetGame();
+  state_ = Paused;
 }
 
 void GameModel::SetGameState(GameState state) {
@@ -99,6 +170,7 @@ void GameModel::SetSpeedUp(bool hold) {
     speed_up_active_ = false;
     interval_ = original_interval_;
   }
+  SyncClockStep();
 }
 
 void GameModel::CheckCollisions() {
@@ -120,7 +192,9 @@ void GameModel::HandleWinLoose(GameState state) {
 void GameModel::HandleAppleEating() {
   snake_.Grow();
   IncrementScore();
-  apple_.SpawnApple(snake_.GetOccupiedPositon());
+  TouchCell(apple_.GetPosition());
+  apple_.SpawnApple(free_cells_);
+  TouchCell(apple_.GetPosition());
   if (snake_.GetBody().size() >= 200) {
     HandleWinLoose(Win);
   }
@@ -130,8 +204,146 @@ void GameModel::HandleAppleEating() {
 }
 
 void GameModel::UpdateGame() {
+  Position tail = snake_.GetBody().back().position;
   snake_.Move();
+  if (!snake_.IsOccupied(tail)) {
+    free_cells_.Release(tail);
+  }
+  free_cells_.Occupy(snake_.GetHeadPosition());
+  TouchCell(tail);
+  TouchCell(snake_.GetHeadPosition());
   CheckCollisions();
+  if (recorder_ && replay_step(recorder_)) {
+    uint8_t state[REPLAY_CHECKPOINT_MAX];
+    replay_checkpoint(recorder_, state, Checkpoint(state));
+  }
+}
+
+const Snake &GameModel::GetSnake() const { return snake_; }
+
+const Apple &GameModel::GetApple() const { return apple_; }
+
+uint64_t GameModel::GetSeed() const { return seed_; }
+
+void GameModel::SetRecorder(Replay *replay) { recorder_ = replay; }
+
+void GameModel::RecordInput(UserAction_t action, bool hold) {
+  if (recorder_) {
+    replay_input(recorder_, action, hold);
+  }
+}
+
+uint64_t GameModel::StateHash() const {
+  uint64_t hash = REPLAY_HASH_SEED;
+  for (const auto &segment : snake_.GetBody()) {
+    int cell[] = {segment.position.x, segment.position.y};
+    hash = replay_hash(hash, cell, sizeof(cell));
+  }
+  int state[] = {apple_.GetPosition().x, apple_.GetPosition().y,
+                 score_,   level_,
+                 speed_,   static_cast<int>(state_)};
+  return replay_hash(hash, state, sizeof(state));
+}
+
+size_t GameModel::Checkpoint(uint8_t *state) const {
+  uint8_t *out = state;
+  out = replay_put(out, static_cast<uint8_t>(state_), 1);
+  out = replay_put(out, static_cast<uint32_t>(score_), 4);
+  out = replay_put(out, static_cast<uint32_t>(high_score_), 4);
+  out = replay_put(out, static_cast<uint8_t>(level_), 1);
+  out = replay_put(out, static_cast<uint16_t>(speed_), 2);
+  out = replay_put(out, static_cast<uint16_t>(interval_), 2);
+  out = replay_put(out, static_cast<uint16_t>(original_interval_), 2);
+  out = replay_put(out, speed_up_active_, 1);
+  out = replay_put(out, static_cast<uint8_t>(snake_.GetDirection()), 1);
+  out = replay_put(out, static_cast<uint8_t>(snake_.GetNextDirection()), 1);
+  out = replay_put(out, static_cast<uint8_t>(apple_.GetPosition().x), 1);
+  out = replay_put(out, static_cast<uint8_t>(apple_.GetPosition().y), 1);
+  for (uint64_t word : apple_.GetGenerator().s) {
+    out = replay_put(out, word, 8);
+  }
+  out = replay_put(out, static_cast<uint8_t>(free_cells_.Size()), 1);
+  free_cells_.Save(out);
+  out += FIELD_WIDTH * FIELD_HEIGHT;
+  const auto &body = snake_.GetBody();
+  out = replay_put(out, static_cast<uint16_t>(body.size()), 2);
+  for (const auto &segment : body) {
+    out = replay_put(out, static_cast<uint8_t>(segment.position.x), 1);
+    out = replay_put(out, static_cast<uint8_t>(segment.position.y), 1);
+  }
+  return static_cast<size_t>(out - state);
+}
+
+bool GameModel::Restore(const uint8_t *state, size_t size) {
+  if (size < kCheckpointHeaderSize) {
+    return false;
+  }
+  const uint8_t *in = state;
+  uint64_t game_state, score, high_score, level, speed, interval,
+      original_interval, speed_up, direction, next_direction, apple_x, apple_y,
+      free_size, body_size;
+  Rng generator;
+  in = replay_get(in, &game_state, 1);
+  in = replay_get(in, &score, 4);
+  in = replay_get(in, &high_score, 4);
+  in = replay_get(in, &level, 1);
+  in = replay_get(in, &speed, 2);
+  in = replay_get(in, &interval, 2);
+  in = replay_get(in, &original_interval, 2);
+  in = replay_get(in, &speed_up, 1);
+  in = replay_get(in, &direction, 1);
+  in = replay_get(in, &next_direction, 1);
+  in = replay_get(in, &apple_x, 1);
+  in = replay_get(in, &apple_y, 1);
+  for (uint64_t &word : generator.s) {
+    in = replay_get(in, &word, 8);
+  }
+  in = replay_get(in, &free_size, 1);
+  const uint8_t *free_cells = in;
+  in += FIELD_WIDTH * FIELD_HEIGHT;
+  in = replay_get(in, &body_size, 2);
+  if (game_state > Win || direction > 3 || next_direction > 3 ||
+      body_size == 0 || body_size > FIELD_WIDTH * FIELD_HEIGHT ||
+      size != kCheckpointHeaderSize + kCheckpointSegmentSize * body_size) {
+    return false;
+  }
+  std::vector<Position> body;
+  body.reserve(body_size);
+  for (uint64_t i = 0; i < body_size; ++i) {
+    body.emplace_back(static_cast<int8_t>(in[0]), static_cast<int8_t>(in[1]));
+    in += kCheckpointSegmentSize;
+  }
+  if (!free_cells_.Restore(free_cells, static_cast<int>(free_size))) {
+    return false;
+  }
+
+  snake_ = Snake(body, static_cast<Direction>(direction),
+                 static_cast<Direction>(next_direction));
+  apple_.Restore(Position(static_cast<int>(apple_x), static_cast<int>(apple_y)),
+                 generator);
+  score_ = static_cast<int>(score);
+  high_score_ = static_cast<int>(high_score);
+  level_ = static_cast<int>(level);
+  speed_ = static_cast<int>(speed);
+  interval_ = static_cast<double>(interval);
+  original_interval_ = static_cast<double>(original_interval);
+  speed_up_active_ = speed_up != 0;
+  state_ = static_cast<GameState>(game_state);
+  SyncClockStep();
+  Stop();
+  if (state_ == Running) {
+    Start();
+  }
+  full_repaint_ = true;
+  touched_cells_.clear();
+  return true;
+}
+
+void GameModel::SyncFreeCells() {
+  free_cells_.Reset();
+  for (const auto &segment : snake_.GetBody()) {
+    free_cells_.Occupy(segment.position);
+  }
 }
 
 bool GameModel::CheckIsOnField(Position position) const {
@@ -171,6 +383,10 @@ void GameModel::UpdateHighScore() {
 }
 
 void GameModel::LoadHighScore() {
+  if (!persist_high_score_) {
+    high_score_ = 0;
+    return;
+  }
   std::ifstream file("highscore.txt");
   if (file.is_open()) {
     file >> high_score_;
@@ -181,6 +397,9 @@ void GameModel::LoadHighScore() {
 }
 
 void GameModel::SaveHighScore() {
+  if (!persist_high_score_) {
+    return;
+  }
   std::ofstream file("highscore.txt");
   if (file.is_open()) {
     file << high_score_;
@@ -189,29 +408,32 @@ void GameModel::SaveHighScore() {
 }
 
 void GameModel::Start() {
-  running_ = true;
-  last_update_time_ = std::chrono::steady_clock::now();
+  game_clock_start(&clock_, game_clock_now_us());
 }
 
-void GameModel::Stop() { running_ = false; }
+void GameModel::Stop() { game_clock_stop(&clock_); }
 void GameModel::SetInterval(int msec) {
   original_interval_ = msec;
   if (!speed_up_active_) {
     interval_ = original_interval_;
   }
+  SyncClockStep();
+}
+
+void GameModel::SyncClockStep() {
+  game_clock_set_step(&clock_, static_cast<long long>(interval_ * 1000));
 }
 
 bool GameModel::IsTimeToUpdate() {
-  if (!running_)
-    return false;
-  auto now = std::chrono::steady_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-      now - last_update_time_);
-  if (elapsed.count() >= int(interval_)) {
-    last_update_time_ = now;
-    return true;
-  }
-  return false;
+  game_clock_update(&clock_, game_clock_now_us());
+  return game_clock_step(&clock_);
+}
+
+int GameModel::GetTimeToUpdate() const {
+  if (state_ != Running)
+    return -1;
+  long long left = game_clock_time_to_step(&clock_, game_clock_now_us());
+  return left < 0 ? -1 : static_cast<int>((left + 999) / 1000);
 }
 
 } // namespace s21
@@ -6,11 +6,11 @@
 
 #pragma once
 
-#include <chrono>
-#include <random>
 #include <vector>
 
+#include "../../../common/inc/rng.h"
 #include "../../../inc/defines.h"
+#include "free_cells.h"
 #include "position.h"
 
 namespace s21 {
@@ -26,10 +26,28 @@ class Apple {
   /**
    * @brief Конструктор класса Apple.
    *
-   * Инициализирует генератор случайных чисел и создает первое яблоко.
+   * Инициализирует генератор случайных чисел случайным зерном.
    */
   Apple();
 
+  /**
+   * @brief Конструктор класса Apple.
+   *
+   * @param seed Зерно генератора: одинаковое зерно даёт одинаковую
+   * последовательность яблок.
+   */
+  explicit Apple(uint64_t seed);
+
+  /**
+   * @brief Спавнит новое яблоко на игровом поле.
+   *
+   * Выбирает случайную клетку из множества свободных одним запросом к
+   * генератору. Если свободных клеток нет, яблоко остаётся на месте.
+   *
+   * @param free_cells Множество свободных клеток поля.
+   */
+  void SpawnApple(const FreeCells &free_cells);
+
   /**
    * @brief Спавнит новое яблоко на игровом поле.
    *
@@ -47,9 +65,24 @@ class Apple {
    */
   const Position &GetPosition() const;
 
+  /**
+   * @brief Получает состояние генератора яблок.
+   *
+   * @return Константная ссылка на генератор.
+   */
+  const Rng &GetGenerator() const;
+
+  /**
+   * @brief Восстанавливает яблоко из контрольной точки реплея.
+   *
+   * @param position Позиция яблока.
+   * @param generator Состояние генератора яблок.
+   */
+  void Restore(const Position &position, const Rng &generator);
+
  private:
   Position position_;      /**< Текущая позиция яблока на игровом поле. */
-  std::mt19937 generator_; /**< Генератор случайных чисел для спавна яблок. */
+  Rng generator_;      /**< Генератор случайных чисел для спавна яблок. */
 };
 
 }  // namespace s21
@@ -0,0 +1,119 @@
+/**
+ * @file free_cells.h
+ * @brief Заголовочный файл, содержащий класс FreeCells для учёта свободных
+ * клеток игрового поля.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "../../../inc/defines.h"
+#include "position.h"
+
+namespace s21 {
+
+/**
+ * @class FreeCells
+ * @brief Множество свободных клеток поля с операциями за постоянное время.
+ *
+ * Свободные клетки хранятся плотным массивом, за которым следует массив
+ * индексов клетка -> позиция в плотном массиве. Занятие клетки меняет её
+ * местами с последней свободной, поэтому случайная свободная клетка
+ * выбирается одним обращением к массиву.
+ */
+class FreeCells {
+ public:
+  /**
+   * @brief Конструктор класса FreeCells.
+   *
+   * Создаёт множество, в котором свободны все клетки поля.
+   */
+  FreeCells();
+
+  /**
+   * @brief Делает свободными все клетки поля.
+   */
+  void Reset();
+
+  /**
+   * @brief Помечает клетку занятой.
+   *
+   * Клетки за пределами поля и уже занятые клетки игнорируются.
+   *
+   * @param position Позиция клетки.
+   */
+  void Occupy(const Position &position);
+
+  /**
+   * @brief Помечает клетку свободной.
+   *
+   * Клетки за пределами поля и уже свободные клетки игнорируются.
+   *
+   * @param position Позиция клетки.
+   */
+  void Release(const Position &position);
+
+  /**
+   * @brief Проверяет, свободна ли клетка.
+   *
+   * @param position Позиция клетки.
+   * @return true, если клетка на поле и свободна, иначе false.
+   */
+  bool IsFree(const Position &position) const;
+
+  /**
+   * @brief Получает количество свободных клеток.
+   *
+   * @return Количество свободных клеток.
+   */
+  int Size() const;
+
+  /**
+   * @brief Получает свободную клетку по её номеру.
+   *
+   * @param index Номер клетки от 0 до Size() - 1.
+   * @return Позиция свободной клетки.
+   */
+  Position At(int index) const;
+
+  /**
+   * @brief Сохраняет порядок клеток для контрольной точки реплея.
+   *
+   * От порядка зависит, какую клетку выберет следующее яблоко, поэтому он
+   * сохраняется целиком, а не восстанавливается по телу змейки.
+   *
+   * @param cells Буфер на FIELD_WIDTH * FIELD_HEIGHT номеров клеток.
+   */
+  void Save(uint8_t *cells) const;
+
+  /**
+   * @brief Восстанавливает состояние, сохранённое методом Save().
+   *
+   * @param cells Номера клеток в сохранённом порядке.
+   * @param size Количество свободных клеток.
+   * @return true, если номера образуют перестановку клеток поля; иначе
+   * состояние не меняется.
+   */
+  bool Restore(const uint8_t *cells, int size);
+
+ private:
+  static constexpr int kCellsCount =
+      FIELD_WIDTH * FIELD_HEIGHT; /**< Количество клеток поля. */
+
+  std::array<int, kCellsCount>
+      cells_; /**< Номера клеток, первые size_ из них свободны. */
+  std::array<int, kCellsCount>
+      index_; /**< Позиция каждой клетки в массиве cells_. */
+  int size_;  /**< Количество свободных клеток. */
+
+  /**
+   * @brief Вычисляет номер клетки поля.
+   *
+   * @param position Позиция клетки.
+   * @return Номер клетки или -1, если позиция вне поля.
+   */
+  static int CellId(const Position &position);
+};
+
+}  // namespace s21
@@ -6,11 +6,16 @@
 
 #pragma once
 
-#include <chrono>
 #include <fstream>
+#include <memory>
+#include <vector>
 
+#include "../../../common/inc/frame_buffer.h"
+#include "../../../common/inc/game_clock.h"
+#include "../../../common/inc/replay.h"
 #include "../../../inc/defines.h"
 #include "apple.h"
+#include "free_cells.h"
 #include "position.h"
 #include "snake.h"
 
@@ -32,6 +37,23 @@ class GameModel {
    */
   GameModel();
 
+  /**
+   * @brief Конструктор класса GameModel.
+   *
+   * @param persist_high_score Читать и сохранять ли рекорд в файле. Модели
+   * без сохранения можно запускать параллельно в нескольких потоках.
+   */
+  explicit GameModel(bool persist_high_score);
+
+  /**
+   * @brief Конструктор класса GameModel.
+   *
+   * @param persist_high_score Читать и сохранять ли рекорд в файле.
+   * @param seed Зерно генератора яблок: модели с одинаковым зерном при
+   * одинаковом вводе проходят одинаковую игру.
+   */
+  GameModel(bool persist_high_score, uint64_t seed);
+
   /**
    * @brief Деструктор класса GameModel.
    *
@@ -42,11 +64,44 @@ class GameModel {
   /**
    * @brief Обновляет текущее состояние игры.
    *
+   * Перерисовывает в поле только клетки, изменившиеся с прошлого вызова:
+   * при обычном шаге это голова, хвост и яблоко.
+   *
    * @return Структура GameInfo_t, содержащая информацию о текущем состоянии
-   * игры.
+   * игры. Поле changed_cells содержит число изменившихся клеток.
    */
   GameInfo_t UpdateCurrentState();
 
+  /**
+   * @brief Выполняет все шаги змейки, время которых уже наступило.
+   */
+  void Advance();
+
+  /**
+   * @brief Возвращает текущее состояние игры, не продвигая её.
+   *
+   * @return Структура GameInfo_t с текущей информацией об игре.
+   */
+  GameInfo_t GetCurrentState();
+
+  /**
+   * @brief Копирует текущее состояние игры в самостоятельный кадр.
+   *
+   * Кадр не ссылается на поле модели, поэтому его можно отрисовывать в другом
+   * потоке, пока модель продолжает игру.
+   *
+   * @param frame Кадр для заполнения.
+   */
+  void Snapshot(Frame *frame);
+
+  /**
+   * @brief Получает клетки, изменившиеся при последнем вызове
+   * UpdateCurrentState().
+   *
+   * @return Константная ссылка на вектор позиций изменившихся клеток.
+   */
+  const std::vector<Position> &GetDirtyCells() const;
+
   /**
    * @brief Получает текущее состояние игры.
    *
@@ -54,6 +109,75 @@ class GameModel {
    */
   GameState GetGameState() const;
 
+  /**
+   * @brief Получает змейку.
+   *
+   * @return Константная ссылка на змейку.
+   */
+  const Snake &GetSnake() const;
+
+  /**
+   * @brief Получает яблоко.
+   *
+   * @return Константная ссылка на яблоко.
+   */
+  const Apple &GetApple() const;
+
+  /**
+   * @brief Получает зерно генератора яблок.
+   *
+   * @return Зерно, с которым создана модель.
+   */
+  uint64_t GetSeed() const;
+
+  /**
+   * @brief Начинает запись ввода и шагов игры в реплей.
+   *
+   * Вызывается сразу после создания модели, до первого ввода.
+   *
+   * @param replay Реплей для записи, принадлежит вызывающему; nullptr
+   * останавливает запись.
+   */
+  void SetRecorder(Replay *replay);
+
+  /**
+   * @brief Записывает ввод пользователя в реплей, если запись включена.
+   *
+   * @param action Действие пользователя.
+   * @param hold Флаг удержания клавиши.
+   */
+  void RecordInput(UserAction_t action, bool hold);
+
+  /**
+   * @brief Вычисляет хеш всего, от чего зависит продолжение игры.
+   *
+   * Рекорд не учитывается, так как он читается из файла.
+   *
+   * @return Хеш состояния игры.
+   */
+  uint64_t StateHash() const;
+
+  /**
+   * @brief Сохраняет всё состояние игры в контрольную точку реплея.
+   *
+   * Сохраняются тело и направление змейки, яблоко с генератором, порядок
+   * свободных клеток, счёт, уровень и интервалы таймера.
+   *
+   * @param state Буфер на REPLAY_CHECKPOINT_MAX байт.
+   * @return Количество записанных байт.
+   */
+  size_t Checkpoint(uint8_t *state) const;
+
+  /**
+   * @brief Восстанавливает игру из контрольной точки, записанной методом
+   * Checkpoint().
+   *
+   * @param state Байты контрольной точки.
+   * @param size Количество байт.
+   * @return true, если контрольная точка корректна; иначе игра не меняется.
+   */
+  bool Restore(const uint8_t *state, size_t size);
+
   /**
    * @brief Инициализирует игровое поле.
    *
@@ -64,7 +188,7 @@ class GameModel {
   /**
    * @brief Очищает игровое поле.
    *
-   * Удаляет все объекты и сбрасывает поле в исходное состояние.
+   * Обнуляет все клетки поля.
    */
   void ClearField();
 
@@ -75,6 +199,17 @@ class GameModel {
    */
   void ResetGame();
 
+  /**
+   * @brief Начинает новую игру с новым зерном генератора яблок.
+   *
+   * Приводит модель в то же состояние, что и конструктор с этим зерном, но
+   * без выделения памяти, поэтому одну модель можно переиспользовать для
+   * многих игр подряд. Рекорд сохраняется.
+   *
+   * @param seed Зерно генератора яблок.
+   */
+  void Restart(uint64_t seed);
+
   /**
    * @brief Устанавливает новое состояние игры.
    *
@@ -234,14 +369,66 @@ class GameModel {
   /**
    * @brief Проверяет, пора ли обновлять состояние.
    *
-   * @return true, если прошло достаточно времени с последнего обновления, иначе
-   * false.
+   * Каждый вызов забирает из часов не более одного шага фиксированной длины,
+   * поэтому змейка движется с точной скоростью при любой частоте отрисовки.
+   *
+   * @return true, если накоплено время хотя бы на один шаг, иначе false.
    */
   bool IsTimeToUpdate();
 
+  /**
+   * @brief Возвращает время до следующего шага змейки.
+   *
+   * @return Число миллисекунд до шага или -1, если игра не идёт и шагов не
+   * ожидается.
+   */
+  int GetTimeToUpdate() const;
+
  private:
+  static constexpr int kMaxCatchUpSteps =
+      3; /**< Сколько шагов можно догнать после задержки кадра. */
+  static constexpr size_t kCheckpointHeaderSize =
+      1 + 4 + 4 + 1 + 3 * 2 + 1 + 2 * 1 + 2 * 1 + sizeof(Rng::s) + 1 +
+      FIELD_WIDTH * FIELD_HEIGHT +
+      2; /**< Байт контрольной точки до тела: состояние, счёт, рекорд,
+            уровень, скорость и интервалы, ускорение, направления, яблоко,
+            генератор, свободные клетки и длина тела. */
+  static constexpr size_t kCheckpointSegmentSize =
+      2; /**< Байт одного сегмента тела в контрольной точке. */
+
+  /**
+   * @brief Передаёт текущий интервал в часы игры.
+   */
+  void SyncClockStep();
+
+  /**
+   * @brief Заново заполняет множество свободных клеток по телу змейки.
+   */
+  void SyncFreeCells();
+
+  /**
+   * @brief Запоминает клетку, содержимое которой могло измениться.
+   *
+   * @param position Позиция клетки.
+   */
+  void TouchCell(const Position &position);
+
+  /**
+   * @brief Вычисляет значение клетки поля по змейке и яблоку.
+   *
+   * @param position Позиция клетки.
+   * @return Значение клетки для поля GameInfo_t.
+   */
+  int CellValue(const Position &position) const;
+
+  /**
+   * @brief Переносит изменения в поле и заполняет список изменившихся клеток.
+   */
+  void RepaintCells();
+
   Snake snake_; /**< Объект класса Snake, представляющий змейку. */
   Apple apple_; /**< Объект класса Apple, представляющий яблоко. */
+  FreeCells free_cells_; /**< Клетки поля, не занятые змейкой. */
 
   int score_;      /**< Текущее количество очков. */
   int high_score_; /**< Рекордное количество очков. */
@@ -250,14 +437,20 @@ class GameModel {
 
   double interval_;          /**< Текущий интервал таймера в миллисекундах. */
   double original_interval_; /**< Исходный интервал таймера в миллисекундах. */
-  bool running_;             /**< Флаг, указывающий, запущен ли таймер. */
   bool speed_up_active_;     /**< Флаг, указывающий, активно ли ускорение. */
-  std::chrono::steady_clock::time_point
-      last_update_time_; /**< Время последнего обновления. */
+  GameClock clock_;          /**< Часы с фиксированным шагом змейки. */
 
   GameState state_; /**< Текущее состояние игры. */
-  std::unique_ptr<int*[]>
-      field_; /**< Указатель на массив, представляющий игровое поле. */
+  bool persist_high_score_; /**< Флаг сохранения рекорда в файле. */
+  uint64_t seed_;           /**< Зерно генератора яблок. */
+  Replay *recorder_;        /**< Реплей, в который пишется игра, или nullptr. */
+  alignas(FIELD_ALIGN) FieldRow
+      field_[FIELD_HEIGHT]; /**< Непрерывный буфер строк игрового поля. */
+  std::vector<Position>
+      touched_cells_; /**< Клетки, которые могли измениться с прошлого кадра. */
+  std::vector<Position>
+      dirty_cells_;   /**< Клетки, изменившиеся в последнем кадре. */
+  bool full_repaint_; /**< Флаг необходимости перерисовать всё поле. */
 };
 
 }  // namespace s21
@@ -5,7 +5,9 @@
 
 #pragma once
 
-#include <deque>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "../../../inc/defines.h"
@@ -21,6 +23,11 @@ namespace s21 {
 struct SnakeSegment {
   Position position;
 
+  /**
+   * @brief Конструктор по умолчанию: сегмент в клетке (0, 0).
+   */
+  SnakeSegment() : position(0, 0) {}
+
   /**
    * @brief Конструктор структуры SnakeSegment.
    *
@@ -30,6 +37,130 @@ struct SnakeSegment {
   SnakeSegment(int x, int y) : position(x, y) {}
 };
 
+/**
+ * @class SnakeBody
+ * @brief Кольцевой буфер сегментов змейки фиксированной ёмкости.
+ *
+ * Змейка не бывает длиннее поля, поэтому тело целиком лежит внутри объекта:
+ * шаг змейки, рост и сброс игры не выделяют память, в отличие от
+ * std::deque, который заводит новый блок каждые несколько десятков шагов.
+ * Интерфейс повторяет нужную часть std::deque.
+ */
+class SnakeBody {
+ public:
+  static constexpr size_t kCapacity =
+      256; /**< Ёмкость буфера, степень двойки больше числа клеток поля. */
+
+  /**
+   * @class ConstIterator
+   * @brief Итератор по сегментам от головы к хвосту.
+   */
+  class ConstIterator {
+   public:
+    ConstIterator(const SnakeBody *body, size_t index)
+        : body_(body), index_(index) {}
+    const SnakeSegment &operator*() const { return (*body_)[index_]; }
+    const SnakeSegment *operator->() const { return &(*body_)[index_]; }
+    ConstIterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    bool operator==(const ConstIterator &other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const ConstIterator &other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const SnakeBody *body_; /**< Обходимое тело змейки. */
+    size_t index_;          /**< Номер сегмента от головы. */
+  };
+
+  /**
+   * @brief Получает количество сегментов.
+   *
+   * @return Длина змейки.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Получает сегмент по номеру.
+   *
+   * @param index Номер сегмента от головы, меньше size().
+   * @return Константная ссылка на сегмент.
+   */
+  const SnakeSegment &operator[](size_t index) const {
+    return segments_[(head_ + index) & (kCapacity - 1)];
+  }
+
+  /**
+   * @brief Получает голову змейки.
+   *
+   * @return Константная ссылка на первый сегмент.
+   */
+  const SnakeSegment &front() const { return (*this)[0]; }
+
+  /**
+   * @brief Получает хвост змейки.
+   *
+   * @return Константная ссылка на последний сегмент.
+   */
+  const SnakeSegment &back() const { return (*this)[size_ - 1]; }
+
+  /**
+   * @brief Добавляет сегмент перед головой.
+   *
+   * @param x Координата X сегмента.
+   * @param y Координата Y сегмента.
+   */
+  void emplace_front(int x, int y) {
+    head_ = (head_ - 1) & (kCapacity - 1);
+    segments_[head_] = SnakeSegment(x, y);
+    ++size_;
+  }
+
+  /**
+   * @brief Добавляет сегмент после хвоста.
+   *
+   * @param x Координата X сегмента.
+   * @param y Координата Y сегмента.
+   */
+  void emplace_back(int x, int y) {
+    segments_[(head_ + size_) & (kCapacity - 1)] = SnakeSegment(x, y);
+    ++size_;
+  }
+
+  /**
+   * @brief Удаляет хвостовой сегмент.
+   */
+  void pop_back() { --size_; }
+
+  /**
+   * @brief Получает итератор на голову.
+   *
+   * @return Итератор на первый сегмент.
+   */
+  ConstIterator begin() const { return ConstIterator(this, 0); }
+
+  /**
+   * @brief Получает итератор за хвостом.
+   *
+   * @return Итератор за последним сегментом.
+   */
+  ConstIterator end() const { return ConstIterator(this, size_); }
+
+ private:
+  static_assert((kCapacity & (kCapacity - 1)) == 0 &&
+                    kCapacity > FIELD_WIDTH * FIELD_HEIGHT,
+                "the body must fit the whole field plus a new head");
+
+  std::array<SnakeSegment, kCapacity>
+      segments_;     /**< Сегменты, начиная с позиции head_ по кругу. */
+  size_t head_ = 0;  /**< Позиция головы в segments_. */
+  size_t size_ = 0;  /**< Количество сегментов. */
+};
+
 /**
  * @enum Direction
  * @brief Перечисление направлений движения змейки.
@@ -51,6 +182,16 @@ class Snake {
    */
   Snake();
 
+  /**
+   * @brief Конструктор класса Snake, восстанавливающий сохранённую змейку.
+   *
+   * @param body Позиции сегментов от головы к хвосту.
+   * @param current_direction Текущее направление движения.
+   * @param next_direction Направление, выбранное для следующего шага.
+   */
+  Snake(const std::vector<Position> &body, Direction current_direction,
+        Direction next_direction);
+
   /**
    * @brief Перемещает змейку в текущем направлении.
    *
@@ -75,10 +216,20 @@ class Snake {
   /**
    * @brief Проверяет, столкнулась ли змейка сама с собой.
    *
+   * Выполняется за постоянное время по сетке занятости.
+   *
    * @return true, если произошло столкновение, иначе false.
    */
   bool CheckSelfCollision() const;
 
+  /**
+   * @brief Проверяет, занята ли клетка поля телом змейки.
+   *
+   * @param position Позиция для проверки.
+   * @return true, если в клетке есть хотя бы один сегмент, иначе false.
+   */
+  bool IsOccupied(const Position &position) const;
+
   /**
    * @brief Получает позицию головы змейки.
    *
@@ -90,9 +241,23 @@ class Snake {
   /**
    * @brief Получает тело змейки.
    *
-   * @return Константная ссылка на deque, содержащий сегменты тела змейки.
+   * @return Константная ссылка на буфер сегментов тела змейки.
+   */
+  const SnakeBody &GetBody() const;
+
+  /**
+   * @brief Получает текущее направление движения змейки.
+   *
+   * @return Направление последнего шага.
    */
-  const std::deque<SnakeSegment> &GetBody() const;
+  Direction GetDirection() const;
+
+  /**
+   * @brief Получает направление, выбранное для следующего шага.
+   *
+   * @return Направление следующего шага.
+   */
+  Direction GetNextDirection() const;
 
   /**
    * @brief Получает все занятые позиции змейки на игровом поле.
@@ -102,10 +267,33 @@ class Snake {
   const std::vector<Position> GetOccupiedPositon() const;
 
  private:
-  std::deque<SnakeSegment>
-      body_; /**< Двусторонняя очередь, представляющая тело змейки. */
+  SnakeBody body_; /**< Кольцевой буфер сегментов тела змейки. */
   Direction current_direction_; /**< Текущее направление движения змейки. */
   Direction next_direction_;    /**< Следующее направление движения змейки. */
+  std::array<std::uint16_t, FIELD_WIDTH * FIELD_HEIGHT>
+      occupancy_{}; /**< Число сегментов змейки в каждой клетке поля. */
+
+  /**
+   * @brief Учитывает сегмент в сетке занятости.
+   *
+   * @param position Позиция сегмента.
+   */
+  void Occupy(const Position &position);
+
+  /**
+   * @brief Убирает сегмент из сетки занятости.
+   *
+   * @param position Позиция сегмента.
+   */
+  void Release(const Position &position);
+
+  /**
+   * @brief Проверяет, находится ли позиция внутри игрового поля.
+   *
+   * @param position Позиция для проверки.
+   * @return true, если позиция находится на поле, иначе false.
+   */
+  static bool IsOnField(const Position &position);
 };
 
 }  // namespace s21
@@ -0,0 +1,152 @@
+/**
+ * @file snake_bot.h
+ * @brief Заголовочный файл, содержащий класс SnakeBot — автопилот змейки.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../../../inc/defines.h"
+#include "game_model.h"
+#include "position.h"
+
+namespace s21 {
+
+/**
+ * @class SnakeBot
+ * @brief Автопилот, ведущий змейку через тот же ввод, что и игрок.
+ *
+ * Поле заранее обходится гамильтоновым циклом, который проходит вверх по
+ * столбцу начальной змейки, так что с самого начала тело лежит на цикле по
+ * порядку от хвоста к голове. Пока этот порядок сохраняется, змейка не
+ * может запереть себя: следующая клетка цикла всегда свободна.
+ *
+ * Каждый шаг бот ищет путь от головы к яблоку алгоритмом A* по битовой
+ * сетке занятых клеток. Прежде чем пойти по пути, он проверяет заливкой,
+ * что после пути до яблока голова ещё доберётся до хвоста, и что первый шаг
+ * не нарушает порядок на цикле и оставляет перед хвостом запас клеток. Если
+ * проверка не прошла, бот срезает по циклу как можно ближе к яблоку или
+ * просто идёт по циклу, поэтому змейка доходит до победы в 200 сегментов.
+ *
+ * Путь до яблока и его проверка переиспользуются, пока змейка идёт по нему,
+ * а все буферы поиска живут в объекте, поэтому шаг не выделяет память.
+ */
+class SnakeBot {
+ public:
+  /**
+   * @brief Конструктор класса SnakeBot.
+   *
+   * Строит гамильтонов цикл поля.
+   */
+  SnakeBot();
+
+  /**
+   * @brief Выбирает действие перед следующим шагом змейки.
+   *
+   * @param model Модель игры, не изменяется.
+   * @return Действие Left, Right, Up или Down для GameController::userInput
+   * или IDLE, если игра не идёт или ходить некуда.
+   */
+  UserAction_t NextAction(const GameModel &model);
+
+ private:
+  static constexpr int kCellsCount =
+      FIELD_WIDTH * FIELD_HEIGHT; /**< Количество клеток поля. */
+  static constexpr int kShortcutReserve =
+      3; /**< Запас клеток перед хвостом сверх длины змейки для срезки. */
+
+  using Grid = std::array<uint16_t, FIELD_HEIGHT>; /**< Строки битов клеток. */
+
+  /**
+   * @brief Загружает тело змейки в буферы бота.
+   *
+   * @param model Модель игры.
+   */
+  void LoadSnake(const GameModel &model);
+
+  /**
+   * @brief Ищет путь A* от головы до цели по клеткам, свободным сейчас.
+   *
+   * Из тела проходим только уходящий хвост, как в Passable(): клетки,
+   * которые хвост освободит позже, считаются занятыми, поэтому поиск
+   * осторожен и может не найти путь, который на деле есть.
+   *
+   * @param goal Номер клетки цели.
+   * @return true, если путь найден; он записывается в path_.
+   */
+  bool FindPath(int goal);
+
+  /**
+   * @brief Проверяет, доберётся ли голова до хвоста после пути до яблока.
+   *
+   * @return true, если хвост достижим из конца пути.
+   */
+  bool TailReachableAfterPath();
+
+  /**
+   * @brief Проверяет заливкой по битовой сетке, достижим ли хвост из головы.
+   *
+   * @param occupied Занятые клетки без головы и хвоста.
+   * @param head Номер клетки головы.
+   * @param tail Номер клетки хвоста.
+   * @return true, если хвост достижим.
+   */
+  static bool Reachable(const Grid &occupied, int head, int tail);
+
+  /**
+   * @brief Проверяет, лежит ли тело на цикле по порядку от хвоста к голове.
+   *
+   * @return true, если порядок соблюдается.
+   */
+  bool OnCycle() const;
+
+  /**
+   * @brief Проверяет, можно ли шагнуть в клетку, сохранив порядок на цикле.
+   *
+   * @param cell Номер соседней с головой клетки.
+   * @param apple Номер клетки яблока.
+   * @return true, если шаг безопасен.
+   */
+  bool CycleMove(int cell, int apple) const;
+
+  /**
+   * @brief Проверяет, свободна ли клетка к следующему шагу змейки.
+   *
+   * @param cell Номер клетки.
+   * @return true, если клетка свободна или это уходящий хвост.
+   */
+  bool Passable(int cell) const;
+
+  /**
+   * @brief Вычисляет расстояние по циклу от хвоста до клетки.
+   *
+   * @param cell Номер клетки.
+   * @return Расстояние от 0 до kCellsCount - 1.
+   */
+  int CycleDistance(int cell) const;
+
+  std::array<int, kCellsCount> cycle_; /**< Номер каждой клетки на цикле. */
+  std::vector<int> body_; /**< Клетки тела от головы к хвосту. */
+  Grid occupied_;         /**< Битовая сетка занятых клеток. */
+  bool tail_stays_; /**< Хвост не сдвинется на следующем шаге: змейка растёт. */
+
+  std::vector<int> path_; /**< Путь до яблока от клетки после головы. */
+  size_t path_step_;      /**< Номер следующей клетки пути. */
+  int path_start_;        /**< Клетка головы, из которой найден путь. */
+  int path_apple_;        /**< Клетка яблока, к которой найден путь. */
+  bool path_safe_; /**< Прошёл ли путь проверку достижимости хвоста. */
+
+  std::array<int, kCellsCount> cost_; /**< Длина лучшего пути до клетки. */
+  std::array<int, kCellsCount> from_; /**< Предыдущая клетка пути. */
+  std::array<uint32_t, kCellsCount>
+      visited_;     /**< Номер поиска, в котором клетка достигнута. */
+  uint32_t search_; /**< Номер текущего поиска. */
+  std::vector<std::pair<int, int>>
+      open_; /**< Куча открытых клеток: оценка и номер клетки. */
+};
+
+}  // namespace s21
@@ -7,11 +7,21 @@ Snake::Snake() {
   int start_y = FIELD_HEIGHT / 2;
   for (int i = 0; i < 4; ++i) {
     body_.emplace_back(start_x, start_y + i);
+    Occupy(body_.back().position);
   }
   current_direction_ = Direction::up;
   next_direction_ = Direction::up;
 }
 
+Snake::Snake(const std::vector<Position> &body, Direction current_direction,
+             Direction next_direction)
+    : current_direction_(current_direction), next_direction_(next_direction) {
+  for (const auto &position : body) {
+    body_.emplace_back(position.x, position.y);
+    Occupy(position);
+  }
+}
+
 void Snake::Move() {
   current_direction_ = next_direction_;
   Position head = GetHeadPosition();
@@ -30,12 +40,15 @@ void Snake::Move() {
     break;
   }
   body_.emplace_front(head.x, head.y);
+  Occupy(head);
+  Release(body_.back().position);
   body_.pop_back();
 }
 
 void Snake::Grow() {
   Position tail = body_.back().position;
   body_.emplace_back(tail.x, tail.y);
+  Occupy(tail);
 }
 
 void Snake::ChangeDirection(Direction new_dir) {
@@ -49,19 +62,40 @@ void Snake::ChangeDirection(Direction new_dir) {
 
 bool Snake::CheckSelfCollision() const {
   const Position &head = GetHeadPosition();
-  for (size_t i = 1; i < body_.size(); ++i) {
-    if (head == body_[i].position) {
-      return true;
-    }
+  return IsOnField(head) && occupancy_[head.y * FIELD_WIDTH + head.x] > 1;
+}
+
+bool Snake::IsOccupied(const Position &position) const {
+  return IsOnField(position) &&
+         occupancy_[position.y * FIELD_WIDTH + position.x] > 0;
+}
+
+void Snake::Occupy(const Position &position) {
+  if (IsOnField(position)) {
+    ++occupancy_[position.y * FIELD_WIDTH + position.x];
   }
-  return false;
+}
+
+void Snake::Release(const Position &position) {
+  if (IsOnField(position)) {
+    --occupancy_[position.y * FIELD_WIDTH + position.x];
+  }
+}
+
+bool Snake::IsOnField(const Position &position) {
+  return position.x >= 0 && position.x < FIELD_WIDTH && position.y >= 0 &&
+         position.y < FIELD_HEIGHT;
 }
 
 const Position &Snake::GetHeadPosition() const {
   return body_.front().position;
 }
 
-const std::deque<SnakeSegment> &Snake::GetBody() const { return body_; }
+const SnakeBody &Snake::GetBody() const { return body_; }
+
+Direction Snake::GetDirection() const { return current_direction_; }
+
+Direction Snake::GetNextDirection() const { return next_direction_; }
 
 const std::vector<Position> Snake::GetOccupiedPositon() const {
   std::vector<Position> positions;
@@ -0,0 +1,285 @@
+#include "inc/snake_bot.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace s21 {
+
+namespace {
+
+constexpr uint16_t kRowMask = (1u << FIELD_WIDTH) - 1;
+
+static_assert(FIELD_WIDTH % 2 == 0 && FIELD_WIDTH <= 16,
+              "the cycle needs an even number of columns that fit a row");
+
+/**
+ * @brief Соседняя клетка и действие, ведущее в неё.
+ */
+struct Move {
+  int dx;
+  int dy;
+  UserAction_t action;
+};
+
+constexpr Move kMoves[] = {
+    {0, -1, Up}, {1, 0, Right}, {0, 1, Down}, {-1, 0, Left}};
+
+int Neighbour(int cell, const Move &move) {
+  int x = cell % FIELD_WIDTH + move.dx;
+  int y = cell / FIELD_WIDTH + move.dy;
+  if (x < 0 || x >= FIELD_WIDTH || y < 0 || y >= FIELD_HEIGHT) {
+    return -1;
+  }
+  return y * FIELD_WIDTH + x;
+}
+
+int Manhattan(int from, int to) {
+  return std::abs(from % FIELD_WIDTH - to % FIELD_WIDTH) +
+         std::abs(from / FIELD_WIDTH - to / FIELD_WIDTH);
+}
+
+void SetCell(std::array<uint16_t, FIELD_HEIGHT> *grid, int cell) {
+  (*grid)[cell / FIELD_WIDTH] |= 1u << (cell % FIELD_WIDTH);
+}
+
+void ClearCell(std::array<uint16_t, FIELD_HEIGHT> *grid, int cell) {
+  (*grid)[cell / FIELD_WIDTH] &= ~(1u << (cell % FIELD_WIDTH));
+}
+
+bool HasCell(const std::array<uint16_t, FIELD_HEIGHT> &grid, int cell) {
+  return (grid[cell / FIELD_WIDTH] >> (cell % FIELD_WIDTH)) & 1u;
+}
+
+}  // namespace
+
+SnakeBot::SnakeBot()
+    : occupied_{}, tail_stays_(false), path_step_(0), path_start_(-1),
+      path_apple_(-1), path_safe_(false), cost_{}, from_{}, visited_{},
+      search_(0) {
+  // Столбцы проходятся змейкой по строкам 1..FIELD_HEIGHT - 1: чётные вниз,
+  // нечётные вверх, как начальная змейка; строка 0 ведёт обратно.
+  int order = 0;
+  for (int x = 0; x < FIELD_WIDTH; ++x) {
+    for (int i = 1; i < FIELD_HEIGHT; ++i) {
+      int y = x % 2 == 0 ? i : FIELD_HEIGHT - i;
+      cycle_[y * FIELD_WIDTH + x] = order++;
+    }
+  }
+  for (int x = FIELD_WIDTH - 1; x >= 0; --x) {
+    cycle_[x] = order++;
+  }
+  body_.reserve(SnakeBody::kCapacity);
+  path_.reserve(kCellsCount);
+  open_.reserve(4 * kCellsCount);
+}
+
+UserAction_t SnakeBot::NextAction(const GameModel &model) {
+  if (model.GetGameState() != Running) {
+    return IDLE;
+  }
+  LoadSnake(model);
+  int head = body_.front();
+  const Position &apple_position = model.GetApple().GetPosition();
+  int apple = apple_position.y * FIELD_WIDTH + apple_position.x;
+
+  bool following =
+      apple == path_apple_ && path_step_ < path_.size() &&
+      head == (path_step_ == 0 ? path_start_ : path_[path_step_ - 1]);
+  if (!following) {
+    path_step_ = 0;
+    path_start_ = head;
+    path_apple_ = apple;
+    path_safe_ = FindPath(apple) && TailReachableAfterPath();
+  }
+
+  bool on_cycle = OnCycle();
+  int next = -1;
+  if (path_safe_ && path_step_ < path_.size() &&
+      Passable(path_[path_step_]) &&
+      (!on_cycle || CycleMove(path_[path_step_], apple))) {
+    next = path_[path_step_++];
+  } else {
+    path_apple_ = -1;
+  }
+
+  UserAction_t action = IDLE;
+  int best = -1;
+  for (const Move &move : kMoves) {
+    int cell = Neighbour(head, move);
+    if (cell < 0) {
+      continue;
+    }
+    if (cell == next) {
+      return move.action;
+    }
+    if (next >= 0 || !Passable(cell)) {
+      continue;
+    }
+    int rating = 0;
+    if (on_cycle) {
+      // Чем дальше по циклу, тем короче путь до яблока.
+      if (!CycleMove(cell, apple)) {
+        continue;
+      }
+      rating = (cycle_[cell] - cycle_[head] + kCellsCount) % kCellsCount;
+    } else {
+      Grid occupied = occupied_;
+      if (!tail_stays_) {
+        ClearCell(&occupied, body_.back());
+      }
+      int tail = body_[body_.size() - (tail_stays_ ? 1 : 2)];
+      ClearCell(&occupied, tail);
+      rating = kCellsCount - Manhattan(cell, apple);
+      if (Reachable(occupied, cell, tail)) {
+        rating += kCellsCount;
+      }
+    }
+    if (rating > best) {
+      best = rating;
+      action = move.action;
+    }
+  }
+  return action;
+}
+
+void SnakeBot::LoadSnake(const GameModel &model) {
+  body_.clear();
+  occupied_.fill(0);
+  for (const auto &segment : model.GetSnake().GetBody()) {
+    int cell = segment.position.y * FIELD_WIDTH + segment.position.x;
+    body_.push_back(cell);
+    SetCell(&occupied_, cell);
+  }
+  size_t size = body_.size();
+  tail_stays_ = size >= 2 && body_[size - 1] == body_[size - 2];
+}
+
+bool SnakeBot::FindPath(int goal) {
+  path_.clear();
+  int start = body_.front();
+  ++search_;
+  open_.clear();
+  cost_[start] = 0;
+  visited_[start] = search_;
+  open_.emplace_back(Manhattan(start, goal), start);
+  bool found = false;
+  while (!open_.empty() && !found) {
+    std::pop_heap(open_.begin(), open_.end(), std::greater<>());
+    auto [estimate, cell] = open_.back();
+    open_.pop_back();
+    if (estimate > cost_[cell] + Manhattan(cell, goal)) {
+      continue;
+    }
+    found = cell == goal;
+    for (const Move &move : kMoves) {
+      int neighbour = Neighbour(cell, move);
+      if (found || neighbour < 0 || !Passable(neighbour) ||
+          (visited_[neighbour] == search_ &&
+           cost_[neighbour] <= cost_[cell] + 1)) {
+        continue;
+      }
+      visited_[neighbour] = search_;
+      cost_[neighbour] = cost_[cell] + 1;
+      from_[neighbour] = cell;
+      open_.emplace_back(cost_[neighbour] + Manhattan(neighbour, goal),
+                         neighbour);
+      std::push_heap(open_.begin(), open_.end(), std::greater<>());
+    }
+  }
+  if (found) {
+    for (int cell = goal; cell != start; cell = from_[cell]) {
+      path_.push_back(cell);
+    }
+    std::reverse(path_.begin(), path_.end());
+  }
+  return found;
+}
+
+bool SnakeBot::TailReachableAfterPath() {
+  // После пути голова стоит на яблоке, а змейка на сегмент длиннее.
+  size_t length = body_.size() + 1;
+  Grid occupied{};
+  int tail = -1;
+  size_t placed = 0;
+  for (auto cell = path_.rbegin(); cell != path_.rend() && placed < length;
+       ++cell, ++placed) {
+    SetCell(&occupied, *cell);
+    tail = *cell;
+  }
+  for (size_t i = 0; placed < length; ++i, ++placed) {
+    SetCell(&occupied, body_[i]);
+    tail = body_[i];
+  }
+  int head = path_.back();
+  ClearCell(&occupied, head);
+  ClearCell(&occupied, tail);
+  return Reachable(occupied, head, tail);
+}
+
+bool SnakeBot::Reachable(const Grid &occupied, int head, int tail) {
+  Grid reached{};
+  SetCell(&reached, head);
+  bool changed = true;
+  while (changed && !HasCell(reached, tail)) {
+    changed = false;
+    for (int y = 0; y < FIELD_HEIGHT; ++y) {
+      uint16_t spread = reached[y] | (reached[y] << 1) | (reached[y] >> 1);
+      if (y > 0) {
+        spread |= reached[y - 1];
+      }
+      if (y + 1 < FIELD_HEIGHT) {
+        spread |= reached[y + 1];
+      }
+      spread &= ~occupied[y] & kRowMask;
+      if ((spread | reached[y]) != reached[y]) {
+        reached[y] |= spread;
+        changed = true;
+      }
+    }
+  }
+  return HasCell(reached, tail);
+}
+
+bool SnakeBot::OnCycle() const {
+  int previous = kCellsCount;
+  for (int cell : body_) {
+    int distance = CycleDistance(cell);
+    if (distance > previous) {
+      return false;
+    }
+    previous = distance;
+  }
+  return true;
+}
+
+bool SnakeBot::CycleMove(int cell, int apple) const {
+  if (!Passable(cell)) {
+    return false;
+  }
+  int head = body_.front();
+  if ((cycle_[cell] - cycle_[head] + kCellsCount) % kCellsCount == 1) {
+    return true;
+  }
+  // Срезка оставляет позади пустые клетки, поэтому перед хвостом должно
+  // хватать места, чтобы змейка выросла, пока хвост их не пройдёт.
+  int distance = CycleDistance(cell);
+  int head_distance = CycleDistance(head);
+  int ahead = kCellsCount - 1 - distance;
+  if (distance <= head_distance ||
+      ahead < static_cast<int>(body_.size()) + kShortcutReserve) {
+    return false;
+  }
+  int apple_distance = CycleDistance(apple);
+  return apple_distance < head_distance || distance <= apple_distance;
+}
+
+bool SnakeBot::Passable(int cell) const {
+  return !HasCell(occupied_, cell) || (cell == body_.back() && !tail_stays_);
+}
+
+int SnakeBot::CycleDistance(int cell) const {
+  return (cycle_[cell] - cycle_[body_.back()] + kCellsCount) % kCellsCount;
+}
+
+}  // namespace s21
@@ -1,131 +1,100 @@
 #include "./inc/backend.h"
 
+#include "./inc/figures.h"
+
 #include "../../gui/cli/inc/frontend.h"
 
 GameInfo_t* game_init() {
+  GameInfo_t* game = game_init_seeded(PIECES_BAG, rng_random_seed());
+  if (game) {
+    game->persist_score = 1;
+    game->high_score = load_score();
+  }
+  return game;
+}
+
+GameInfo_t* game_init_seeded(PieceMode mode, uint64_t seed) {
   GameInfo_t* game = (GameInfo_t*)malloc(sizeof(GameInfo_t));
+  if (game == NULL) return NULL;
 
+  game->generator = (PieceGenerator*)malloc(sizeof(PieceGenerator));
   game->field = init_game_field();
-  game->next_figure = init_figure(NEXT_FIELD_X, NEXT_FIELD_Y);
+  if (game->generator == NULL || game->field == NULL) {
+    free_game_field(game->field);
+    free(game->generator);
+    free(game);
+    return NULL;
+  }
+  piece_generator_init(game->generator, mode, seed);
+  game->high_score = 0;
+  game->persist_score = 0;
+  game->recorder = NULL;
+  reset_game(game);
+
+  return game;
+}
+
+void reset_game(GameInfo_t* game) {
+  if (game->recorder) replay_input(game->recorder, REPLAY_RESET, false);
+  memset(game->field, 0, FIELD_BYTES);
+  game->next_figure = &game->pieces[1];
+  reset_figure(game->next_figure, piece_generator_next(game->generator),
+               NEXT_FIELD_X, NEXT_FIELD_Y);
   game->score = 0;
-  game->high_score = load_score();
   game->level = 1;
   game->speed = 0;
 
-  game->figure = init_figure(FIGURE_START_X, FIGURE_START_Y);
+  game->figure = &game->pieces[0];
+  reset_figure(game->figure, piece_generator_next(game->generator),
+               FIGURE_START_X, FIGURE_START_Y);
   game->status = Pause;
   game->action = IDLE;
   game->ticks_left = TICKS_START;
-
-  return game;
+  game->changed_cells = -1;
 }
 
 void free_game_init(GameInfo_t* game) {
   if (game) {
     free_game_field(game->field);
-    free_figure(game->next_figure);
-    free_figure(game->figure);
+    free(game->generator);
     free(game);
   }
 }
 
-int** init_game_field() {
-  int** field = (int**)calloc(FIELD_HEIGHT, sizeof(int*));
-  for (int i = 0; i < FIELD_HEIGHT; i++) {
-    field[i] = (int*)calloc(FIELD_WIDTH, sizeof(int));
-  }
+FieldRow* init_game_field() {
+  FieldRow* field = (FieldRow*)aligned_alloc(FIELD_ALIGN, FIELD_BYTES);
+  if (field) memset(field, 0, FIELD_BYTES);
   return field;
 }
 
-void free_game_field(int** field) {
-  if (field) {
-    for (int i = 0; i < FIELD_HEIGHT; i++) {
-      if (field[i]) {
-        free(field[i]);
-      }
-    }
-    free(field);
-  }
-}
+void free_game_field(FieldRow* field) { free(field); }
 
-Figure* init_figure(int figure_x, int figure_y) {
+Figure* init_figure(int figure_num, int figure_x, int figure_y) {
   Figure* f = (Figure*)malloc(sizeof(Figure));
-
-  f->figure_num = rand() % FIGURES_COUNT;
-
-  f->x = figure_x;
-  f->y = figure_y;
-
-  f->figure = (int**)calloc(FIGURE_SIZE, sizeof(int*));
-  for (int i = 0; i < FIGURE_SIZE; i++)
-    f->figure[i] = (int*)calloc(FIGURE_SIZE, sizeof(int));
-
-  get_random_figure(f);
-
+  reset_figure(f, figure_num, figure_x, figure_y);
   return f;
 }
 
-void free_figure(Figure* figure) {
-  if (figure) {
-    for (int i = 0; i < FIGURE_SIZE; i++) {
-      if (figure->figure[i]) {
-        free(figure->figure[i]);
-      }
-    }
-    free(figure->figure);
-    free(figure);
-  }
+void reset_figure(Figure* figure, int figure_num, int figure_x, int figure_y) {
+  figure->figure_num = figure_num;
+  figure->x = figure_x;
+  figure->y = figure_y;
+  get_random_figure(figure);
 }
 
-void get_random_figure(Figure* figure) {
-  int figures[7][FIGURE_SIZE][FIGURE_SIZE] = {
-      // 0. z
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {1, 1, 0, 0, 0},
-       {0, 1, 1, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 1. s
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {0, 2, 2, 0, 0},
-       {2, 2, 0, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 2. T
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {0, 3, 0, 0, 0},
-       {3, 3, 3, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 3. L
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {0, 0, 4, 0, 0},
-       {4, 4, 4, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 4. J
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {5, 0, 0, 0, 0},
-       {5, 5, 5, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 5. square
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {0, 6, 6, 0, 0},
-       {0, 6, 6, 0, 0},
-       {0, 0, 0, 0, 0}},
-      // 6. bar
-      {{0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0},
-       {7, 7, 7, 7, 0},
-       {0, 0, 0, 0, 0},
-       {0, 0, 0, 0, 0}},
-  };
+void free_figure(Figure* figure) { free(figure); }
+
+void get_random_figure(Figure* figure) { set_figure_rotation(figure, 0); }
 
+void set_figure_rotation(Figure* figure, int rotation) {
+  const uint8_t* rows = figure_rows[figure->figure_num][rotation];
+  int color = figure->figure_num + 1;
+
+  figure->rotation = rotation;
   for (int i = 0; i < FIGURE_SIZE; i++) {
-    memcpy(figure->figure[i], figures[figure->figure_num][i],
-           sizeof(int) * FIGURE_SIZE);
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      figure->figure[i][j] = (rows[i] >> j) & 1 ? color : 0;
+    }
   }
 }
 
@@ -161,6 +130,170 @@ void clear_figure_from_field(GameInfo_t* game) {
   }
 }
 
+void snapshot_game(const GameInfo_t* game, Frame* frame) {
+  memcpy(frame->field, game->field, FIELD_BYTES);
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      int cell = game->figure->figure[i][j];
+      int field_x = game->figure->x + j;
+      int field_y = game->figure->y + i - 2;
+      if (cell != 0 && field_x >= 0 && field_x < FIELD_WIDTH && field_y >= 0 &&
+          field_y < FIELD_HEIGHT) {
+        frame->field[field_y][field_x] = cell;
+      }
+      frame->next[i][j] = game->next_figure->figure[i][j];
+    }
+  }
+  frame->score = game->score;
+  frame->high_score = game->high_score;
+  frame->level = game->level;
+  frame->speed = game->speed;
+  frame->pause = game->status == Pause;
+  frame->state = game->status;
+}
+
+uint64_t hash_game(const GameInfo_t* game) {
+  int paused = game->status == Pause || game->status == GAMEOVER;
+  int state[] = {game->figure->figure_num,
+                 game->figure->rotation,
+                 game->figure->x,
+                 game->figure->y,
+                 game->next_figure->figure_num,
+                 game->score,
+                 game->level,
+                 game->speed,
+                 game->status,
+                 paused ? TICKS_START : game->ticks_left};
+  uint64_t hash = replay_hash(REPLAY_HASH_SEED, game->field, FIELD_BYTES);
+  return replay_hash(hash, state, sizeof(state));
+}
+
+static uint8_t* save_figure(const Figure* figure, uint8_t* out) {
+  out = replay_put(out, figure->figure_num, 1);
+  out = replay_put(out, figure->rotation, 1);
+  out = replay_put(out, (uint8_t)figure->x, 1);
+  return replay_put(out, (uint8_t)figure->y, 1);
+}
+
+static const uint8_t* load_figure(const uint8_t* in, int* figure_num,
+                                  int* rotation, int* x, int* y) {
+  uint64_t value = 0;
+  in = replay_get(in, &value, 1);
+  *figure_num = (int)value;
+  in = replay_get(in, &value, 1);
+  *rotation = (int)value;
+  in = replay_get(in, &value, 1);
+  *x = (int8_t)value;
+  in = replay_get(in, &value, 1);
+  *y = (int8_t)value;
+  return in;
+}
+
+size_t checkpoint_game(const GameInfo_t* game, uint8_t* state) {
+  uint8_t* out = state;
+  for (int plane = 0; plane < CHECKPOINT_COLOR_PLANES; plane++) {
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      uint16_t bits = 0;
+      for (int col = 0; col < FIELD_WIDTH; col++) {
+        bits |= ((game->field[row][col] >> plane) & 1u) << col;
+      }
+      out = replay_put(out, bits, 2);
+    }
+  }
+  out = save_figure(game->figure, out);
+  out = save_figure(game->next_figure, out);
+  out = replay_put(out, (uint32_t)game->score, 4);
+  out = replay_put(out, (uint32_t)game->high_score, 4);
+  out = replay_put(out, (uint16_t)game->level, 2);
+  out = replay_put(out, (uint32_t)game->speed, 4);
+  out = replay_put(out, (uint8_t)game->status, 1);
+  out = replay_put(out, (uint16_t)game->ticks_left, 2);
+  out = piece_generator_save(game->generator, out);
+  return (size_t)(out - state);
+}
+
+/**
+ * @brief Checks that a restored figure lies inside the field and covers only
+ * empty cells. A lost game leaves the figure overlapping the field at the
+ * spawn position, so overlap is allowed there.
+ */
+static bool figure_fits(const uint8_t colors[FIELD_HEIGHT][FIELD_WIDTH],
+                        const int figure[4]) {
+  const uint8_t* masks = figure_rows[figure[0]][figure[1]];
+  bool spawned = figure[2] == FIGURE_START_X && figure[3] == FIGURE_START_Y;
+  bool fits = true;
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      if (((masks[i] >> j) & 1u) == 0) continue;
+      int field_x = figure[2] + j;
+      int field_y = figure[3] + i - 2;
+      if (field_x < 0 || field_x >= FIELD_WIDTH || field_y < 0 ||
+          field_y >= FIELD_HEIGHT) {
+        fits = false;
+      } else if (colors[field_y][field_x] != 0 && !spawned) {
+        fits = false;
+      }
+    }
+  }
+  return fits;
+}
+
+static bool status_valid(uint64_t status) {
+  return status == Start || status == Pause || status == Terminate ||
+         status == GAMEOVER || status == RESET;
+}
+
+bool restore_game(GameInfo_t* game, const uint8_t* state, size_t size) {
+  if (size != TETRIS_CHECKPOINT_SIZE) return false;
+  const uint8_t* in = state;
+  uint64_t value = 0;
+  uint8_t colors[FIELD_HEIGHT][FIELD_WIDTH] = {{0}};
+  for (int plane = 0; plane < CHECKPOINT_COLOR_PLANES; plane++) {
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      in = replay_get(in, &value, 2);
+      for (int col = 0; col < FIELD_WIDTH; col++) {
+        colors[row][col] |= (uint8_t)(((value >> col) & 1u) << plane);
+      }
+    }
+  }
+  int figure[4], next[4];
+  in = load_figure(in, &figure[0], &figure[1], &figure[2], &figure[3]);
+  in = load_figure(in, &next[0], &next[1], &next[2], &next[3]);
+  uint64_t score, high_score, level, speed, status, ticks_left;
+  in = replay_get(in, &score, 4);
+  in = replay_get(in, &high_score, 4);
+  in = replay_get(in, &level, 2);
+  in = replay_get(in, &speed, 4);
+  in = replay_get(in, &status, 1);
+  in = replay_get(in, &ticks_left, 2);
+  // The speed stays 0 until the first figure lands.
+  bool valid = figure[0] < FIGURES_COUNT && figure[1] < FIGURE_ROTATIONS &&
+               figure_fits(colors, figure) && next[0] < FIGURES_COUNT &&
+               next[1] < FIGURE_ROTATIONS && next[2] == NEXT_FIELD_X &&
+               next[3] == NEXT_FIELD_Y && level >= 1 && level <= MAX_LEVEL &&
+               (speed == level * BASE_SPEED || (speed == 0 && level == 1)) &&
+               status_valid(status) && ticks_left <= TICKS_START &&
+               piece_generator_restore(game->generator, in);
+  if (!valid) return false;
+
+  for (int row = 0; row < FIELD_HEIGHT; row++) {
+    memcpy(game->field[row], colors[row], FIELD_WIDTH);
+  }
+  reset_figure(game->figure, figure[0], figure[2], figure[3]);
+  set_figure_rotation(game->figure, figure[1]);
+  reset_figure(game->next_figure, next[0], next[2], next[3]);
+  set_figure_rotation(game->next_figure, next[1]);
+  game->score = (int)(uint32_t)score;
+  game->high_score = (int)(uint32_t)high_score;
+  game->level = (int)level;
+  game->speed = (int)(uint32_t)speed;
+  game->status = (int)status;
+  game->ticks_left = (int16_t)ticks_left;
+  game->action = IDLE;
+  game->changed_cells = -1;
+  return true;
+}
+
 int collision(GameInfo_t* game) {
   int flag = 0;
   for (int i = 0; i < FIGURE_SIZE; i++) {
@@ -180,15 +313,9 @@ int collision(GameInfo_t* game) {
 
 void drop_filled_lines(int i, GameInfo_t* game) {
   if (i == 0) {
-    for (int j = 0; j < FIELD_WIDTH; j++) {
-      game->field[i][j] = 0;
-    }
+    memset(game->field[0], 0, FIELD_STRIDE);
   } else {
-    for (int k = i; k > 0; k--) {
-      for (int j = 0; j < FIELD_WIDTH; j++) {
-        game->field[k][j] = game->field[k - 1][j];
-      }
-    }
+    memmove(game->field[1], game->field[0], i * FIELD_STRIDE);
   }
 }
 
@@ -200,10 +327,16 @@ void erase_and_score(GameInfo_t* game) {
       count++;
     }
   }
-  if (count == 1) game->score += 100;
-  if (count == 2) game->score += 300;
-  if (count == 3) game->score += 700;
-  if (count == 4) game->score += 1500;
+  game->score += score_for_lines(count);
+}
+
+int score_for_lines(int count) {
+  int points = 0;
+  if (count == 1) points = 100;
+  if (count == 2) points = 300;
+  if (count == 3) points = 700;
+  if (count == 4) points = 1500;
+  return points;
 }
 
 int check_filled_line(int i, const GameInfo_t* game) {
@@ -251,6 +384,14 @@ void calculate_speed(GameInfo_t* game) {
   game->speed = game->level * BASE_SPEED;
 }
 
+long tick_interval_us(const GameInfo_t* game) {
+  return (TICK_DURATION - game->speed) / 1000;
+}
+
+int ticks_until_gravity(const GameInfo_t* game) {
+  return game->ticks_left > 0 ? game->ticks_left + 1 : 1;
+}
+
 int load_score() {
   int max_score = 0;
   FILE* file = fopen("max_score.txt", "r");
@@ -266,6 +407,7 @@ void update_max_score(GameInfo_t* game) {
 }
 
 void save_max_score(const GameInfo_t* game) {
+  if (!game->persist_score) return;
   FILE* file = fopen("max_score.txt", "w");
   if (file != NULL) {
     fprintf(file, "%d", game->high_score);
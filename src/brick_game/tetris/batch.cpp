@@ -0,0 +1,541 @@
+#include "./inc/batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "./inc/figures.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BATCH_AVX2 1
+#endif
+
+#define BATCH_FULL_ROW 0xFFFFFFFFu /**< Row with every bit set. */
+#define BATCH_LANE_ARRAYS 12 /**< int32_t arrays of one value per board. */
+#define BATCH_SHAPES \
+  (FIGURES_COUNT * FIGURE_ROTATIONS) /**< Figure and rotation pairs. */
+
+#define BATCH_SHAPE_ROW_MASK \
+  ((1u << FIGURE_SIZE) - 1u) /**< Bits of one row of a packed shape. */
+
+static_assert(FIGURE_SIZE * FIGURE_SIZE <= 32,
+              "a figure must pack into one 32-bit shape");
+
+/**
+ * @brief Figure rows in the form the steps test them.
+ *
+ * packed holds figure_rows of a figure and rotation in one word, row i at bit
+ * FIGURE_SIZE * i, so the AVX2 step gathers a whole figure at once instead of
+ * one row at a time. first_row is the first row any figure fills; the rows
+ * above it are never tested.
+ */
+struct ShapeTable {
+  uint32_t packed[BATCH_SHAPES];
+  int first_row;
+};
+
+static constexpr ShapeTable make_shapes() {
+  ShapeTable table = {};
+  table.first_row = FIGURE_SIZE;
+  for (int num = 0; num < FIGURES_COUNT; num++) {
+    for (int rotation = 0; rotation < FIGURE_ROTATIONS; rotation++) {
+      for (int i = 0; i < FIGURE_SIZE; i++) {
+        uint8_t row = figure_rows[num][rotation][i];
+        table.packed[num * FIGURE_ROTATIONS + rotation] |=
+            (uint32_t)row << (FIGURE_SIZE * i);
+        if (row != 0 && i < table.first_row) table.first_row = i;
+      }
+    }
+  }
+  return table;
+}
+
+static constexpr ShapeTable batch_shapes = make_shapes();
+
+static size_t align_size(size_t size) {
+  return (size + FIELD_ALIGN - 1) / FIELD_ALIGN * FIELD_ALIGN;
+}
+
+static void *carve(uint8_t **cursor, size_t size) {
+  void *block = *cursor;
+  *cursor += align_size(size);
+  return block;
+}
+
+static uint32_t *board_row(const TetrisBatch *batch, int board, int row) {
+  return &batch->rows[(size_t)row * batch->stride + board];
+}
+
+static int collides(const TetrisBatch *batch, int board, int piece,
+                    int rotation, int x, int y) {
+  const uint8_t *shape = figure_rows[piece][rotation];
+  uint32_t hit = 0;
+  for (int i = batch_shapes.first_row; i < FIGURE_SIZE; i++) {
+    hit |= ((uint32_t)shape[i] << (x + TETRIS_BATCH_WALL)) &
+           *board_row(batch, board, y + i);
+  }
+  return hit != 0;
+}
+
+static int collides_now(const TetrisBatch *batch, int board) {
+  return collides(batch, board, batch->piece[board], batch->rotation[board],
+                  batch->x[board], batch->y[board]);
+}
+
+static void clear_board(TetrisBatch *batch, int board) {
+  for (int row = 0; row < TETRIS_BATCH_ROWS; row++) {
+    int field_row = row - TETRIS_BATCH_TOP;
+    *board_row(batch, board, row) = field_row >= 0 && field_row < FIELD_HEIGHT
+                                        ? TETRIS_BATCH_EMPTY_ROW
+                                        : BATCH_FULL_ROW;
+  }
+  memset(batch->colors[board], 0, FIELD_BYTES);
+}
+
+static void spawn_board(TetrisBatch *batch, int board) {
+  batch->piece[board] = batch->next_piece[board];
+  batch->rotation[board] = 0;
+  batch->x[board] = FIGURE_START_X;
+  batch->y[board] = FIGURE_START_Y;
+  batch->next_piece[board] = piece_generator_next(&batch->generators[board]);
+}
+
+// Same as drop_filled_lines(): row 0 is cleared only when it is the filled
+// row itself, otherwise it stays and is also copied down.
+static void drop_row(TetrisBatch *batch, int board, int row) {
+  FieldRow *colors = batch->colors[board];
+  if (row == 0) {
+    *board_row(batch, board, TETRIS_BATCH_TOP) = TETRIS_BATCH_EMPTY_ROW;
+    memset(colors[0], 0, FIELD_STRIDE);
+    return;
+  }
+  for (int i = row; i > 0; i--) {
+    *board_row(batch, board, i + TETRIS_BATCH_TOP) =
+        *board_row(batch, board, i - 1 + TETRIS_BATCH_TOP);
+  }
+  memmove(colors[1], colors[0], row * FIELD_STRIDE);
+}
+
+static void plant_board(TetrisBatch *batch, int board) {
+  int piece = batch->piece[board];
+  int x = batch->x[board], y = batch->y[board];
+  const uint8_t *shape = figure_rows[piece][batch->rotation[board]];
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    if (shape[i] == 0) continue;
+    *board_row(batch, board, y + i) |= (uint32_t)shape[i]
+                                       << (x + TETRIS_BATCH_WALL);
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      if ((shape[i] >> j) & 1) {
+        batch->colors[board][y + i - 2][x + j] = (uint8_t)(piece + 1);
+      }
+    }
+  }
+
+  int count = 0;
+  for (int row = FIELD_HEIGHT - 1; row >= 0; row--) {
+    while (*board_row(batch, board, row + TETRIS_BATCH_TOP) == BATCH_FULL_ROW) {
+      drop_row(batch, board, row);
+      count++;
+    }
+  }
+  batch->score[board] += score_for_lines(count);
+  if (batch->score[board] > batch->high_score[board]) {
+    batch->high_score[board] = batch->score[board];
+  }
+  while (batch->score[board] >= 600 * batch->level[board] &&
+         batch->level[board] < 10) {
+    batch->level[board]++;
+  }
+  batch->speed[board] = batch->level[board] * BASE_SPEED;
+  spawn_board(batch, board);
+
+  if (collides_now(batch, board)) {
+    batch->status[board] = GAMEOVER;
+    batch->over[board] = 1;
+  }
+}
+
+static void gravity_board(TetrisBatch *batch, int board) {
+  if (batch->ticks_left[board] <= 0) {
+    batch->ticks_left[board] = TICKS_START;
+    if (collides(batch, board, batch->piece[board], batch->rotation[board],
+                 batch->x[board], batch->y[board] + 1)) {
+      plant_board(batch, board);
+    } else {
+      batch->y[board]++;
+    }
+  }
+}
+
+static void move_board(TetrisBatch *batch, int board, int dx, int dy) {
+  if (!collides(batch, board, batch->piece[board], batch->rotation[board],
+                batch->x[board] + dx, batch->y[board] + dy)) {
+    batch->x[board] += dx;
+    batch->y[board] += dy;
+  }
+}
+
+static void rotate_board(TetrisBatch *batch, int board) {
+  static const int kicks[] = {0, -1, -2, 1, 2};
+  int rotation = (batch->rotation[board] + 1) % FIGURE_ROTATIONS;
+  for (int kick : kicks) {
+    int x = batch->x[board] + kick;
+    if (!collides(batch, board, batch->piece[board], rotation, x,
+                  batch->y[board])) {
+      batch->rotation[board] = rotation;
+      batch->x[board] = x;
+      break;
+    }
+  }
+}
+
+static void drop_board(TetrisBatch *batch, int board) {
+  if (collides_now(batch, board)) return;
+  while (!collides(batch, board, batch->piece[board], batch->rotation[board],
+                   batch->x[board], batch->y[board] + 1)) {
+    batch->y[board]++;
+  }
+  plant_board(batch, board);
+}
+
+static void act_board(TetrisBatch *batch, int board, int action) {
+  switch (action) {
+    case Up:
+      rotate_board(batch, board);
+      break;
+    case Left:
+      move_board(batch, board, -1, 0);
+      break;
+    case Right:
+      move_board(batch, board, 1, 0);
+      break;
+    case Down:
+      move_board(batch, board, 0, 1);
+      break;
+    case Action:
+      drop_board(batch, board);
+      break;
+    case Pause:
+      batch->status[board] = Pause;
+      break;
+    case Terminate:
+      batch->status[board] = Terminate;
+      break;
+    case Start:
+      if (batch->status[board] == GAMEOVER) {
+        batch->status[board] = RESET;
+      } else {
+        batch->status[board] = Start;
+      }
+      break;
+    case IDLE:
+    default:
+      break;
+  }
+}
+
+static void update_board_ticks(TetrisBatch *batch, int board) {
+  if (batch->status[board] != Pause && batch->status[board] != GAMEOVER) {
+    batch->ticks_left[board]--;
+  } else {
+    batch->ticks_left[board] = TICKS_START;
+  }
+}
+
+static void step_scalar(TetrisBatch *batch, const uint8_t *actions) {
+  for (int board = 0; board < batch->count; board++) {
+    if (batch->over[board]) continue;
+    gravity_board(batch, board);
+    act_board(batch, board, actions[board]);
+    update_board_ticks(batch, board);
+  }
+}
+
+#ifdef BATCH_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static int lanes_of(__m256i mask) {
+  return _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+}
+
+AVX2 static __m256i load_lanes(const int32_t *array, int base) {
+  return _mm256_load_si256((const __m256i *)&array[base]);
+}
+
+AVX2 static void store_lanes(int32_t *array, int base, __m256i value) {
+  _mm256_store_si256((__m256i *)&array[base], value);
+}
+
+/**
+ * @brief Collision test of eight boards, the vector form of collides().
+ * @return Mask of the lanes whose figure hits a wall or a block.
+ */
+AVX2 static __m256i collides_lanes(const TetrisBatch *batch, int base,
+                                   __m256i shape, __m256i x, __m256i y) {
+  const __m256i boards = _mm256_add_epi32(
+      _mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i stride = _mm256_set1_epi32(batch->stride);
+  const __m256i row_mask = _mm256_set1_epi32(BATCH_SHAPE_ROW_MASK);
+  __m256i shift = _mm256_add_epi32(x, _mm256_set1_epi32(TETRIS_BATCH_WALL));
+  __m256i packed = _mm256_srli_epi32(
+      _mm256_i32gather_epi32((const int *)batch_shapes.packed, shape, 4),
+      FIGURE_SIZE * batch_shapes.first_row);
+  __m256i row = _mm256_add_epi32(
+      _mm256_mullo_epi32(
+          _mm256_add_epi32(y, _mm256_set1_epi32(batch_shapes.first_row)),
+          stride),
+      boards);
+  __m256i hit = _mm256_setzero_si256();
+  for (int i = batch_shapes.first_row; i < FIGURE_SIZE; i++) {
+    __m256i mask = _mm256_and_si256(packed, row_mask);
+    __m256i cells = _mm256_i32gather_epi32((const int *)batch->rows, row, 4);
+    hit = _mm256_or_si256(
+        hit, _mm256_and_si256(_mm256_sllv_epi32(mask, shift), cells));
+    packed = _mm256_srli_epi32(packed, FIGURE_SIZE);
+    row = _mm256_add_epi32(row, stride);
+  }
+  return _mm256_xor_si256(_mm256_cmpeq_epi32(hit, _mm256_setzero_si256()),
+                          _mm256_set1_epi32(-1));
+}
+
+AVX2 static __m256i shape_lanes(__m256i piece, __m256i rotation) {
+  return _mm256_add_epi32(_mm256_slli_epi32(piece, 2), rotation);
+}
+
+AVX2 static void gravity_lanes(TetrisBatch *batch, int base, __m256i active) {
+  __m256i ticks = load_lanes(batch->ticks_left, base);
+  __m256i due = _mm256_and_si256(
+      active, _mm256_cmpgt_epi32(_mm256_set1_epi32(1), ticks));
+  if (!lanes_of(due)) return;
+  store_lanes(batch->ticks_left, base,
+              _mm256_blendv_epi8(ticks, _mm256_set1_epi32(TICKS_START), due));
+
+  __m256i y = load_lanes(batch->y, base);
+  __m256i hit = collides_lanes(
+      batch, base,
+      shape_lanes(load_lanes(batch->piece, base),
+                  load_lanes(batch->rotation, base)),
+      load_lanes(batch->x, base), _mm256_sub_epi32(y, due));
+  // A lane mask is -1, so subtracting it moves the figure one row down.
+  store_lanes(batch->y, base,
+              _mm256_sub_epi32(y, _mm256_andnot_si256(hit, due)));
+  int planted = lanes_of(_mm256_and_si256(hit, due));
+  for (int lane = 0; planted; lane++, planted >>= 1) {
+    if (planted & 1) plant_board(batch, base + lane);
+  }
+}
+
+AVX2 static void move_lanes(TetrisBatch *batch, int base, __m256i active,
+                            __m256i action) {
+  __m256i left = _mm256_cmpeq_epi32(action, _mm256_set1_epi32(Left));
+  __m256i right = _mm256_cmpeq_epi32(action, _mm256_set1_epi32(Right));
+  __m256i down = _mm256_cmpeq_epi32(action, _mm256_set1_epi32(Down));
+  __m256i up = _mm256_and_si256(
+      active, _mm256_cmpeq_epi32(action, _mm256_set1_epi32(Up)));
+  __m256i move = _mm256_and_si256(
+      active, _mm256_or_si256(_mm256_or_si256(left, right), down));
+  if (!lanes_of(_mm256_or_si256(move, up))) return;
+
+  __m256i piece = load_lanes(batch->piece, base);
+  __m256i rotation = load_lanes(batch->rotation, base);
+  __m256i x = load_lanes(batch->x, base);
+  __m256i y = load_lanes(batch->y, base);
+  if (lanes_of(move)) {
+    __m256i moved_x = _mm256_add_epi32(x, _mm256_sub_epi32(left, right));
+    __m256i moved_y = _mm256_sub_epi32(y, down);
+    __m256i hit = collides_lanes(batch, base, shape_lanes(piece, rotation),
+                                 moved_x, moved_y);
+    __m256i done = _mm256_andnot_si256(hit, move);
+    x = _mm256_blendv_epi8(x, moved_x, done);
+    y = _mm256_blendv_epi8(y, moved_y, done);
+  }
+  if (lanes_of(up)) {
+    static const int kicks[] = {0, -1, -2, 1, 2};
+    static_assert((FIGURE_ROTATIONS & (FIGURE_ROTATIONS - 1)) == 0,
+                  "rotations wrap with a mask instead of %");
+    __m256i turned = _mm256_and_si256(_mm256_add_epi32(rotation,
+                                                       _mm256_set1_epi32(1)),
+                                      _mm256_set1_epi32(FIGURE_ROTATIONS - 1));
+    __m256i shape = shape_lanes(piece, turned);
+    __m256i pending = up;
+    __m256i kicked_x = x;
+    for (int kick : kicks) {
+      __m256i candidate = _mm256_add_epi32(x, _mm256_set1_epi32(kick));
+      __m256i hit = collides_lanes(batch, base, shape, candidate, y);
+      kicked_x = _mm256_blendv_epi8(kicked_x, candidate,
+                                    _mm256_andnot_si256(hit, pending));
+      pending = _mm256_and_si256(pending, hit);
+      if (!lanes_of(pending)) break;
+    }
+    __m256i done = _mm256_andnot_si256(pending, up);
+    rotation = _mm256_blendv_epi8(rotation, turned, done);
+    x = _mm256_blendv_epi8(x, kicked_x, done);
+  }
+  store_lanes(batch->rotation, base, rotation);
+  store_lanes(batch->x, base, x);
+  store_lanes(batch->y, base, y);
+}
+
+AVX2 static void update_lanes_ticks(TetrisBatch *batch, int base,
+                                    __m256i active) {
+  __m256i status = load_lanes(batch->status, base);
+  __m256i ticks = load_lanes(batch->ticks_left, base);
+  __m256i stopped = _mm256_or_si256(
+      _mm256_cmpeq_epi32(status, _mm256_set1_epi32(Pause)),
+      _mm256_cmpeq_epi32(status, _mm256_set1_epi32(GAMEOVER)));
+  __m256i updated =
+      _mm256_blendv_epi8(_mm256_sub_epi32(ticks, _mm256_set1_epi32(1)),
+                         _mm256_set1_epi32(TICKS_START), stopped);
+  store_lanes(batch->ticks_left, base,
+              _mm256_blendv_epi8(ticks, updated, active));
+}
+
+AVX2 static void step_avx2(TetrisBatch *batch, const uint8_t *actions) {
+  for (int base = 0; base < batch->stride; base += TETRIS_BATCH_LANES) {
+    uint8_t lane_actions[TETRIS_BATCH_LANES];
+    memset(lane_actions, IDLE, sizeof(lane_actions));
+    int lanes = batch->count - base < TETRIS_BATCH_LANES ? batch->count - base
+                                                         : TETRIS_BATCH_LANES;
+    memcpy(lane_actions, &actions[base], lanes);
+    __m256i action =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)lane_actions));
+    __m256i active = _mm256_cmpeq_epi32(load_lanes(batch->over, base),
+                                        _mm256_setzero_si256());
+
+    gravity_lanes(batch, base, active);
+    move_lanes(batch, base, active, action);
+    // Drops, pauses and starts are rare and branchy, so they run per board.
+    __m256i others = _mm256_or_si256(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(Left), action),
+        _mm256_cmpeq_epi32(action, _mm256_set1_epi32(Action)));
+    int boards = lanes_of(_mm256_and_si256(active, others));
+    for (int lane = 0; boards; lane++, boards >>= 1) {
+      if (boards & 1) act_board(batch, base + lane, lane_actions[lane]);
+    }
+    update_lanes_ticks(batch, base, active);
+  }
+}
+
+#endif
+
+bool tetris_batch_simd_available(void) {
+#ifdef BATCH_AVX2
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+TetrisBatch *tetris_batch_init(int count) {
+  if (count < 0) return NULL;
+  int stride = (count + TETRIS_BATCH_LANES - 1) / TETRIS_BATCH_LANES *
+               TETRIS_BATCH_LANES;
+  size_t lane_bytes = align_size((size_t)stride * sizeof(int32_t));
+  size_t size =
+      align_size(sizeof(TetrisBatch)) +
+      align_size((size_t)TETRIS_BATCH_ROWS * stride * sizeof(uint32_t)) +
+      align_size((size_t)stride * FIELD_BYTES) +
+      BATCH_LANE_ARRAYS * lane_bytes +
+      align_size((size_t)stride * sizeof(PieceGenerator));
+  uint8_t *cursor = (uint8_t *)aligned_alloc(FIELD_ALIGN, size);
+  if (cursor == NULL) return NULL;
+
+  TetrisBatch *batch = (TetrisBatch *)carve(&cursor, sizeof(TetrisBatch));
+  batch->count = count;
+  batch->stride = stride;
+  batch->simd = tetris_batch_simd_available();
+  batch->rows = (uint32_t *)carve(
+      &cursor, (size_t)TETRIS_BATCH_ROWS * stride * sizeof(uint32_t));
+  batch->colors =
+      (FieldRow(*)[FIELD_HEIGHT])carve(&cursor, (size_t)stride * FIELD_BYTES);
+  int32_t **lanes[] = {&batch->piece,      &batch->rotation, &batch->x,
+                       &batch->y,          &batch->next_piece,
+                       &batch->ticks_left, &batch->status,   &batch->score,
+                       &batch->high_score, &batch->level,    &batch->speed,
+                       &batch->over};
+  for (int32_t **lane : lanes) *lane = (int32_t *)carve(&cursor, lane_bytes);
+  batch->generators = (PieceGenerator *)carve(
+      &cursor, (size_t)stride * sizeof(PieceGenerator));
+
+  for (int board = 0; board < stride; board++) {
+    tetris_batch_reset(batch, board, PIECES_BAG, 0);
+    batch->over[board] = board >= count;
+  }
+  return batch;
+}
+
+void tetris_batch_free(TetrisBatch *batch) { free(batch); }
+
+void tetris_batch_reset(TetrisBatch *batch, int board, PieceMode mode,
+                        uint64_t seed) {
+  PieceGenerator *generator = &batch->generators[board];
+  piece_generator_init(generator, mode, seed);
+  clear_board(batch, board);
+  // reset_game() deals the next figure before the falling one, which the
+  // first spawn_new() replaces.
+  batch->next_piece[board] = piece_generator_next(generator);
+  piece_generator_next(generator);
+  spawn_board(batch, board);
+  batch->ticks_left[board] = TICKS_START;
+  batch->status[board] = Pause;
+  batch->score[board] = 0;
+  batch->high_score[board] = 0;
+  batch->level[board] = 1;
+  batch->speed[board] = 0;
+  batch->over[board] = 0;
+}
+
+void tetris_batch_load(TetrisBatch *batch, int board, const GameInfo_t *game) {
+  clear_board(batch, board);
+  for (int row = 0; row < FIELD_HEIGHT; row++) {
+    uint32_t *mask = board_row(batch, board, row + TETRIS_BATCH_TOP);
+    for (int col = 0; col < FIELD_WIDTH; col++) {
+      if (game->field[row][col] != 0) {
+        *mask |= 1u << (col + TETRIS_BATCH_WALL);
+      }
+    }
+    memcpy(batch->colors[board][row], game->field[row], FIELD_WIDTH);
+  }
+  batch->piece[board] = game->figure->figure_num;
+  batch->rotation[board] = game->figure->rotation;
+  batch->x[board] = game->figure->x;
+  batch->y[board] = game->figure->y;
+  batch->next_piece[board] = game->next_figure->figure_num;
+  batch->ticks_left[board] = game->ticks_left;
+  batch->status[board] = game->status;
+  batch->score[board] = game->score;
+  batch->high_score[board] = game->high_score;
+  batch->level[board] = game->level;
+  batch->speed[board] = game->speed;
+  batch->over[board] = game->status == GAMEOVER;
+  batch->generators[board] = *game->generator;
+}
+
+void tetris_batch_store(const TetrisBatch *batch, int board, GameInfo_t *game) {
+  memcpy(game->field, batch->colors[board], FIELD_BYTES);
+  reset_figure(game->figure, batch->piece[board], batch->x[board],
+               batch->y[board]);
+  set_figure_rotation(game->figure, batch->rotation[board]);
+  reset_figure(game->next_figure, batch->next_piece[board], NEXT_FIELD_X,
+               NEXT_FIELD_Y);
+  game->ticks_left = batch->ticks_left[board];
+  game->status = batch->status[board];
+  game->score = batch->score[board];
+  game->high_score = batch->high_score[board];
+  game->level = batch->level[board];
+  game->speed = batch->speed[board];
+  game->action = IDLE;
+  game->changed_cells = -1;
+  *game->generator = batch->generators[board];
+}
+
+void tetris_batch_step(TetrisBatch *batch, const uint8_t *actions) {
+#ifdef BATCH_AVX2
+  if (batch->simd) {
+    step_avx2(batch, actions);
+    return;
+  }
+#endif
+  step_scalar(batch, actions);
+}
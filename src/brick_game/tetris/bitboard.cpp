@@ -0,0 +1,94 @@
+#include "./inc/bitboard.h"
+
+void bitboard_clear(Bitboard* board) {
+  for (int i = 0; i < FIELD_HEIGHT; i++) board->rows[i] = BITBOARD_EMPTY_ROW;
+  memset(board->colors, 0, sizeof(board->colors));
+}
+
+void bitboard_load_field(Bitboard* board, const FieldRow* field) {
+  memcpy(board->colors, field, FIELD_BYTES);
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    uint16_t row = BITBOARD_EMPTY_ROW;
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      if (field[i][j] != 0) row |= (uint16_t)(1u << (j + BITBOARD_WALL));
+    }
+    board->rows[i] = row;
+  }
+}
+
+void bitboard_store_field(const Bitboard* board, FieldRow* field) {
+  memcpy(field, board->colors, FIELD_BYTES);
+}
+
+void bitboard_figure_masks(const Figure* figure, uint8_t masks[FIGURE_SIZE]) {
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    uint8_t mask = 0;
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      if (figure->figure[i][j] != 0) mask |= (uint8_t)(1u << j);
+    }
+    masks[i] = mask;
+  }
+}
+
+int bitboard_collision(const Bitboard* board, const uint8_t masks[FIGURE_SIZE],
+                       int x, int y) {
+  int shift = x + BITBOARD_WALL;
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    uint32_t mask = masks[i];
+    if (mask == 0) continue;
+
+    int field_y = y + i - 2;
+    if (field_y < 0 || field_y >= FIELD_HEIGHT) return 1;
+
+    if (shift < 0) {
+      if (mask & ((1u << -shift) - 1u)) return 1;
+      mask >>= -shift;
+    } else {
+      mask <<= shift;
+    }
+    if ((board->rows[field_y] | 0xFFFF0000u) & mask) return 1;
+  }
+  return 0;
+}
+
+void bitboard_place_figure(Bitboard* board, const Figure* figure) {
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      if (figure->figure[i][j] != 0) {
+        int field_x = figure->x + j;
+        int field_y = figure->y + i - 2;
+
+        if (field_x >= 0 && field_x < FIELD_WIDTH && field_y >= 0 &&
+            field_y < FIELD_HEIGHT) {
+          board->rows[field_y] |= (uint16_t)(1u << (field_x + BITBOARD_WALL));
+          board->colors[field_y][field_x] = (uint8_t)figure->figure[i][j];
+        }
+      }
+    }
+  }
+}
+
+int bitboard_check_filled_line(const Bitboard* board, int i) {
+  return board->rows[i] == BITBOARD_FULL_ROW;
+}
+
+void bitboard_drop_filled_lines(Bitboard* board, int i) {
+  if (i == 0) {
+    board->rows[0] = BITBOARD_EMPTY_ROW;
+    memset(board->colors[0], 0, sizeof(board->colors[0]));
+  } else {
+    memmove(&board->rows[1], &board->rows[0], i * sizeof(board->rows[0]));
+    memmove(board->colors[1], board->colors[0], i * sizeof(board->colors[0]));
+  }
+}
+
+int bitboard_erase_filled_lines(Bitboard* board) {
+  int count = 0;
+  for (int i = FIELD_HEIGHT - 1; i >= 0; i--) {
+    while (bitboard_check_filled_line(board, i)) {
+      bitboard_drop_filled_lines(board, i);
+      count++;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,276 @@
+#include "./inc/bot.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./inc/bitboard.h"
+#include "./inc/figures.h"
+#include "./inc/piece_generator.h"
+
+#define BOT_MIN_X -2 /**< Leftmost x-coordinate any figure can take. */
+#define BOT_BEAM 4 /**< Best placements whose next figure is searched. */
+
+// Weights tuned by Yiyuan Lee for this set of features.
+static const TetrisBotWeights default_weights = {0.760666, -0.510066,
+                                                 -0.35663, -0.184483};
+
+/**
+ * @brief Column heights and holes of a field, the features the rating
+ * needs besides cleared lines.
+ */
+typedef struct FieldStats {
+  int heights[FIELD_WIDTH];
+  int holes;
+} FieldStats;
+
+/**
+ * @brief A placement of the searched figure and the field it leaves.
+ */
+typedef struct Placement {
+  double rating;
+  int rotation;
+  int x;
+  int lines;
+  Bitboard board;
+} Placement;
+
+static void field_stats(const Bitboard *board, FieldStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  unsigned covered = 0;
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    unsigned cells = board->rows[i] & BITBOARD_FIELD_MASK;
+    stats->holes += __builtin_popcount(covered & ~cells);
+    for (unsigned fresh = cells & ~covered; fresh; fresh &= fresh - 1) {
+      stats->heights[__builtin_ctz(fresh) - BITBOARD_WALL] = FIELD_HEIGHT - i;
+    }
+    covered |= cells;
+  }
+}
+
+static double rate_stats(const TetrisBotWeights *weights,
+                         const FieldStats *stats, int lines) {
+  int height = stats->heights[0], bumpiness = 0;
+  for (int j = 1; j < FIELD_WIDTH; j++) {
+    height += stats->heights[j];
+    bumpiness += abs(stats->heights[j] - stats->heights[j - 1]);
+  }
+  return weights->lines * lines + weights->height * height +
+         weights->holes * stats->holes + weights->bumpiness * bumpiness;
+}
+
+/**
+ * @brief Updates the stats of a field for a figure landed on it without
+ * clearing lines, instead of scanning the new field.
+ * @return false if the figure lies below the top of a column, where the
+ * holes it covers are not known.
+ */
+static bool land_stats(FieldStats *stats, const uint8_t *masks, int x,
+                       int y) {
+  int top[FIGURE_SIZE], bottom[FIGURE_SIZE];
+  for (int j = 0; j < FIGURE_SIZE; j++) top[j] = bottom[j] = -1;
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    for (unsigned cells = masks[i]; cells; cells &= cells - 1) {
+      int j = __builtin_ctz(cells);
+      if (top[j] < 0) top[j] = y + i - 2;
+      bottom[j] = y + i - 2;
+    }
+  }
+  for (int j = 0; j < FIGURE_SIZE; j++) {
+    if (top[j] < 0) continue;
+    int column = x + j;
+    int column_top = FIELD_HEIGHT - stats->heights[column];
+    if (bottom[j] >= column_top) return false;
+    stats->holes += column_top - bottom[j] - 1;
+    stats->heights[column] = FIELD_HEIGHT - top[j];
+  }
+  return true;
+}
+
+static bool same_shape(int piece, int rotation, int other) {
+  return memcmp(figure_rows[piece][rotation], figure_rows[piece][other],
+                FIGURE_SIZE) == 0;
+}
+
+// Colors are not needed to rate a field, so only the row masks are set.
+static void land(Bitboard *board, const uint8_t *masks, int x, int y) {
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    if (masks[i] != 0) {
+      board->rows[y + i - 2] |= (uint16_t)(masks[i] << (x + BITBOARD_WALL));
+    }
+  }
+}
+
+// The field has no filled rows, so only the rows of the figure can fill.
+static bool fills_line(const Bitboard *board, const uint8_t *masks, int x,
+                       int y) {
+  for (int i = 0; i < FIGURE_SIZE; i++) {
+    if (masks[i] != 0 &&
+        (uint16_t)(board->rows[y + i - 2] |
+                   masks[i] << (x + BITBOARD_WALL)) == BITBOARD_FULL_ROW) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void keep_placement(Placement *beam, int *kept,
+                           const Placement *placement) {
+  int i = *kept < BOT_BEAM ? (*kept)++ : BOT_BEAM;
+  for (; i > 0 && beam[i - 1].rating < placement->rating; i--) {
+    if (i < BOT_BEAM) beam[i] = beam[i - 1];
+  }
+  if (i < BOT_BEAM) beam[i] = *placement;
+}
+
+/**
+ * @brief Finds the first row at or below y where a rotation fits at x.
+ * @return The row, -1 if the rotation needs the figure to fall further than
+ * its own size.
+ */
+static int rotation_row(const Bitboard *board, const uint8_t *masks, int x,
+                        int y) {
+  for (int limit = y + FIGURE_SIZE; y < limit; y++) {
+    if (!bitboard_collision(board, masks, x, y)) return y;
+  }
+  return -1;
+}
+
+/**
+ * @brief Rates the best placement of pieces[0], searching the placements of
+ * the following pieces as well while depth allows.
+ *
+ * The figure is turned one rotation at a time at start_x, falling as far as
+ * each rotation needs to fit, then shifted along that row and dropped. Every
+ * placement is rated by its own field; while depth allows, only the
+ * BOT_BEAM best of them are searched further and rated by what the next
+ * pieces make of them.
+ *
+ * @return Best rating, -DBL_MAX if a later piece cannot spawn, -HUGE_VAL if
+ * pieces[0] has no placement.
+ */
+static double search(const TetrisBot *bot, const Bitboard *board,
+                     const int *pieces, int depth, int start_rotation,
+                     int start_x, int start_y, int lines, int *best_rotation,
+                     int *best_x) {
+  double best = -HUGE_VAL;
+  int piece = pieces[0];
+  int row = start_y;
+  FieldStats stats;
+  field_stats(board, &stats);
+  Placement beam[BOT_BEAM];
+  int kept = 0;
+  for (int turn = 0; turn < FIGURE_ROTATIONS; turn++) {
+    int rotation = (start_rotation + turn) % FIGURE_ROTATIONS;
+    const uint8_t *masks = figure_rows[piece][rotation];
+    row = rotation_row(board, masks, start_x, row);
+    if (row < 0) break;
+    bool seen = false;
+    for (int other = 0; other < turn && !seen; other++) {
+      seen = same_shape(piece, rotation,
+                        (start_rotation + other) % FIGURE_ROTATIONS);
+    }
+    if (seen) continue;
+    for (int x = BOT_MIN_X; x < FIELD_WIDTH; x++) {
+      int y = row;
+      if (bitboard_collision(board, masks, x, y)) continue;
+      while (!bitboard_collision(board, masks, x, y + 1)) y++;
+
+      Placement placement;
+      FieldStats landed = stats;
+      if (depth == 1 && !fills_line(board, masks, x, y) &&
+          land_stats(&landed, masks, x, y)) {
+        placement.rating = rate_stats(&bot->weights, &landed, lines);
+      } else {
+        placement.board = *board;
+        land(&placement.board, masks, x, y);
+        placement.lines = lines + bitboard_erase_filled_lines(&placement.board);
+        field_stats(&placement.board, &landed);
+        placement.rating =
+            rate_stats(&bot->weights, &landed, placement.lines);
+      }
+      placement.rotation = rotation;
+      placement.x = x;
+      if (depth > 1) {
+        keep_placement(beam, &kept, &placement);
+      } else if (placement.rating > best) {
+        best = placement.rating;
+        if (best_rotation != NULL) *best_rotation = rotation;
+        if (best_x != NULL) *best_x = x;
+      }
+    }
+  }
+  for (int i = 0; i < kept; i++) {
+    double rating = search(bot, &beam[i].board, pieces + 1, depth - 1, 0,
+                           FIGURE_START_X, FIGURE_START_Y, beam[i].lines,
+                           NULL, NULL);
+    if (rating == -HUGE_VAL) rating = -DBL_MAX;
+    if (rating > best) {
+      best = rating;
+      if (best_rotation != NULL) *best_rotation = beam[i].rotation;
+      if (best_x != NULL) *best_x = beam[i].x;
+    }
+  }
+  return best;
+}
+
+void tetris_bot_init(TetrisBot *bot, int depth) {
+  bot->weights = default_weights;
+  if (depth < 1) depth = 1;
+  if (depth > TETRIS_BOT_MAX_DEPTH) depth = TETRIS_BOT_MAX_DEPTH;
+  bot->depth = depth;
+  bot->piece = -1;
+  bot->rotation = 0;
+  bot->x = 0;
+  bot->last_action = IDLE;
+  bot->last_x = 0;
+  bot->last_y = 0;
+  bot->last_rotation = 0;
+}
+
+bool tetris_bot_plan(const TetrisBot *bot, const GameInfo_t *game,
+                     int *rotation, int *x) {
+  Bitboard board;
+  bitboard_load_field(&board, game->field);
+  int pieces[TETRIS_BOT_MAX_DEPTH] = {game->figure->figure_num,
+                                      game->next_figure->figure_num};
+  const Figure *figure = game->figure;
+  return search(bot, &board, pieces, bot->depth, figure->rotation, figure->x,
+                figure->y, 0, rotation, x) != -HUGE_VAL;
+}
+
+UserAction_t tetris_bot_action(TetrisBot *bot, const GameInfo_t *game) {
+  if (game->status != Start) return IDLE;
+  const Figure *figure = game->figure;
+  bool blocked = bot->last_action != IDLE && figure->x == bot->last_x &&
+                 figure->y == bot->last_y &&
+                 figure->rotation == bot->last_rotation;
+  if (game->generator->dealt != bot->piece) {
+    bot->piece = game->generator->dealt;
+    blocked = false;
+    if (!tetris_bot_plan(bot, game, &bot->rotation, &bot->x)) {
+      bot->rotation = figure->rotation;
+      bot->x = figure->x;
+    }
+  } else if (blocked && bot->last_action != Up) {
+    // Neither a shift nor a fall helped, so the target cannot be reached.
+    bot->rotation = figure->rotation;
+    bot->x = figure->x;
+  }
+
+  UserAction_t action = Action;
+  if (figure->rotation != bot->rotation) {
+    // A rotation that does not fit yet may fit a row lower.
+    action = blocked ? Down : Up;
+  } else if (figure->x < bot->x) {
+    action = Right;
+  } else if (figure->x > bot->x) {
+    action = Left;
+  }
+  bot->last_action = action == Action ? IDLE : action;
+  bot->last_x = figure->x;
+  bot->last_y = figure->y;
+  bot->last_rotation = figure->rotation;
+  return action;
+}
@@ -4,6 +4,11 @@
 
 void calculate_game(GameInfo_t* game) {
   check_ticks(game);
+  process_action(game);
+  update_ticks(game);
+}
+
+void process_action(GameInfo_t* game) {
   switch (game->action) {
     case Up:
       action_up(game);
@@ -34,25 +39,69 @@ void calculate_game(GameInfo_t* game) {
       break;
   }
   game->action = IDLE;
+}
+
+void tick_game(GameInfo_t* game) {
+  check_ticks(game);
+  update_ticks(game);
+  if (game->recorder && replay_step(game->recorder)) {
+    uint8_t state[TETRIS_CHECKPOINT_SIZE];
+    replay_checkpoint(game->recorder, state, checkpoint_game(game, state));
+  }
+}
+
+void update_ticks(GameInfo_t* game) {
   if (game->status != Pause && game->status != GAMEOVER)
     game->ticks_left--;
   else
     game->ticks_left = TICKS_START;
 }
 
+void init_game_clock(const GameInfo_t* game, GameClock* clock) {
+  game_clock_init(clock, tick_interval_us(game), TICKS_START + 1);
+}
+
+int advance_game(GameInfo_t* game, GameClock* clock, long long now_us) {
+  if (game->status == Pause || game->status == GAMEOVER) {
+    game_clock_stop(clock);
+    update_ticks(game);
+    return 0;
+  }
+  if (!clock->running) {
+    game_clock_start(clock, now_us);
+    return 0;
+  }
+  game_clock_set_step(clock, tick_interval_us(game));
+  game_clock_update(clock, now_us);
+  int ticks = 0;
+  while (game->status != Pause && game->status != GAMEOVER &&
+         game_clock_step(clock)) {
+    tick_game(game);
+    game_clock_set_step(clock, tick_interval_us(game));
+    ticks++;
+  }
+  return ticks;
+}
+
+long long time_to_gravity_us(const GameInfo_t* game, const GameClock* clock,
+                             long long now_us) {
+  long long left = game_clock_time_to_step(clock, now_us);
+  if (left < 0) return -1;
+  return left + (long long)(ticks_until_gravity(game) - 1) *
+                    tick_interval_us(game);
+}
+
 void action_up(GameInfo_t* game) {
-  Figure* figure = rotate(game);
-  Figure* old_figure = game->figure;
-  game->figure = figure;
+  int old_rotation = game->figure->rotation;
+  int old_x = game->figure->x;
+  rotate(game);
   if (collision(game)) game->figure->x -= 1;
   if (collision(game)) game->figure->x -= 1;
   if (collision(game)) game->figure->x += 3;
   if (collision(game)) game->figure->x += 1;
   if (collision(game)) {
-    game->figure = old_figure;
-    free_figure(figure);
-  } else {
-    free_figure(old_figure);
+    set_figure_rotation(game->figure, old_rotation);
+    game->figure->x = old_x;
   }
 }
 
@@ -92,74 +141,128 @@ void action_start(GameInfo_t* game) {
   }
 }
 
-void get_user_action(GameInfo_t* game, int ch) {
-  if (game->status != Pause) {
-    switch (ch) {
-      case KEY_UP:
-        game->action = Up;
-        break;
-      case KEY_LEFT:
-        game->action = Left;
-        break;
-      case KEY_RIGHT:
-        game->action = Right;
-        break;
-      case KEY_DOWN:
-        game->action = Down;
-        break;
-      case 'x':
-      case 'X':
-        game->action = Action;
-        break;
-      default:
-        game->action = IDLE;
-        break;
-    }
-  }
+UserAction_t key_to_action(int ch) {
   switch (ch) {
+    case KEY_UP:
+      return Up;
+    case KEY_LEFT:
+      return Left;
+    case KEY_RIGHT:
+      return Right;
+    case KEY_DOWN:
+      return Down;
+    case 'x':
+    case 'X':
+      return Action;
     case 'p':
     case 'P':
-      game->action = Pause;
-      break;
+      return Pause;
     case 'q':
     case 'Q':
-      game->action = Terminate;
-      break;
+      return Terminate;
     case '\n':
-      game->action = Start;
-      break;
+      return Start;
+    default:
+      return IDLE;
   }
 }
 
-void move_down(GameInfo_t* game) { game->figure->y++; }
+static bool accepts_action(const GameInfo_t* game, UserAction_t action) {
+  return game->status != Pause || action == Pause || action == Terminate ||
+         action == Start;
+}
 
-void move_up(GameInfo_t* game) { game->figure->y--; }
+void get_user_action(GameInfo_t* game, int ch) {
+  UserAction_t action = key_to_action(ch);
+  if (accepts_action(game, action)) game->action = action;
+}
 
-void move_right(GameInfo_t* game) { game->figure->x++; }
+void apply_user_action(GameInfo_t* game, UserAction_t action) {
+  if (!accepts_action(game, action)) return;
+  if (game->recorder) replay_input(game->recorder, action, false);
+  game->action = action;
+  process_action(game);
+}
 
-void move_left(GameInfo_t* game) { game->figure->x--; }
+void record_game(GameInfo_t* game, Replay* replay) {
+  replay_init(replay, REPLAY_TETRIS, game->generator->mode,
+              game->generator->seed);
+  game->recorder = replay;
+}
 
-Figure* rotate(GameInfo_t* game) {
-  Figure* figure = init_figure(FIGURE_START_X, FIGURE_START_Y);
-  Figure* figure_old = game->figure;
+void finish_recording(GameInfo_t* game) {
+  if (game->recorder) {
+    game->recorder->final_hash = hash_game(game);
+    game->recorder = NULL;
+  }
+}
 
-  figure->x = figure_old->x;
-  figure->y = figure_old->y;
-  figure->figure_num = figure_old->figure_num;
+/**
+ * @brief Re-simulates the recorded inputs from the given one up to a step.
+ * @param game Game in the state recorded after the first step ticks.
+ * @param replay Recorded session.
+ * @param input Index of the first input to apply.
+ * @param step Number of steps the game has already taken.
+ * @param until Step to stop at, after applying the inputs recorded there.
+ */
+static void run_replay(GameInfo_t* game, const Replay* replay, size_t input,
+                       unsigned long step, unsigned long until) {
+  for (size_t i = input; i <= replay->count; i++) {
+    bool last = i == replay->count || replay->inputs[i].step > until;
+    unsigned long next = last ? until : replay->inputs[i].step;
+    for (; step < next; step++) tick_game(game);
+    // The game thread advances the clock before every input, which resets
+    // the tick counter of a paused game.
+    if (game->status == Pause || game->status == GAMEOVER) update_ticks(game);
+    if (last) break;
 
-  for (int i = 0; i < FIGURE_SIZE; i++) {
-    for (int j = 0; j < FIGURE_SIZE; j++) {
-      if (figure->figure_num == 6)
-        figure->figure[j][FIGURE_SIZE - 1 - i] =
-            j == 0 ? 0 : figure_old->figure[i][j - 1];
-      else if (figure->figure_num == 5)
-        figure->figure[i][j] = figure_old->figure[i][j];
-      else
-        figure->figure[j][FIGURE_SIZE - 1 - i] =
-            (j == 0 || j == 1) ? 0 : figure_old->figure[i][j - 2];
+    int action = replay->inputs[i].action;
+    if (action == REPLAY_RESET) {
+      reset_game(game);
+    } else {
+      apply_user_action(game, (UserAction_t)action);
     }
   }
-  return figure;
+}
+
+uint64_t replay_tetris(const Replay* replay) {
+  GameInfo_t* game = game_init_seeded((PieceMode)replay->mode, replay->seed);
+  if (game == NULL) return 0;
+  spawn_new(game);
+  run_replay(game, replay, 0, 0, replay->steps);
+  uint64_t hash = hash_game(game);
+  free_game_init(game);
+  return hash;
+}
+
+GameInfo_t* seek_tetris(const Replay* replay, unsigned long step) {
+  GameInfo_t* game = game_init_seeded((PieceMode)replay->mode, replay->seed);
+  if (game == NULL) return NULL;
+  spawn_new(game);
+  if (step > replay->steps) step = replay->steps;
+
+  const ReplayCheckpoint* checkpoint = replay_find_checkpoint(replay, step);
+  if (checkpoint != NULL &&
+      restore_game(game, replay_checkpoint_state(replay, checkpoint),
+                   checkpoint->size)) {
+    run_replay(game, replay, checkpoint->input, checkpoint->step, step);
+  } else {
+    run_replay(game, replay, 0, 0, step);
+  }
+  return game;
+}
+
+void move_down(GameInfo_t* game) { game->figure->y++; }
+
+void move_up(GameInfo_t* game) { game->figure->y--; }
+
+void move_right(GameInfo_t* game) { game->figure->x++; }
+
+void move_left(GameInfo_t* game) { game->figure->x--; }
+
+void rotate(GameInfo_t* game) {
+  set_figure_rotation(game->figure,
+                      (game->figure->rotation + 1) % FIGURE_ROTATIONS);
 }
 
 void plant_figure(GameInfo_t* game) {
@@ -175,12 +278,11 @@ void plant_figure(GameInfo_t* game) {
 }
 
 void spawn_new(GameInfo_t* game) {
-  if (game->figure != NULL) {
-    free_figure(game->figure);
-  }
+  Figure* spent = game->figure;
   game->figure = game->next_figure;
   game->figure->x = FIGURE_START_X;
   game->figure->y = FIGURE_START_Y;
-  game->next_figure = init_figure(NEXT_FIELD_X, NEXT_FIELD_Y);
-  get_random_figure(game->next_figure);
+  game->next_figure = spent;
+  reset_figure(game->next_figure, piece_generator_next(game->generator),
+               NEXT_FIELD_X, NEXT_FIELD_Y);
 }
\ No newline at end of file
@@ -13,7 +13,10 @@
 #include <string.h>
 #include <time.h>
 
+#include "../../common/inc/frame_buffer.h"
+#include "../../common/inc/replay.h"
 #include "../../inc/defines.h"
+#include "piece_generator.h"
 
 /**
  * @brief Enumeration of game states.
@@ -27,13 +30,41 @@ enum {
   RESET,
 };
 
+#define CHECKPOINT_COLOR_PLANES 3 /**< Bit planes holding a cell color. */
+#define TETRIS_CHECKPOINT_SIZE                                           \
+  (CHECKPOINT_COLOR_PLANES * FIELD_HEIGHT * 2 + 2 * 4 + 4 + 4 + 2 + 4 + \
+   1 + 2 + PIECE_GENERATOR_STATE_SIZE) /**< Bytes of a game checkpoint. */
+
 /**
  * @brief Initializes the game state and returns a pointer to the GameInfo_t
- * structure.
- * @return Pointer to the initialized GameInfo_t structure.
+ * structure. Figures are dealt from a 7-bag with a random seed and the high
+ * score is loaded from and saved to disk.
+ * @return Pointer to the initialized GameInfo_t structure, NULL if memory
+ * ran out.
  */
 GameInfo_t *game_init();
 
+/**
+ * @brief Initializes the game state with the given randomizer and seed, so
+ * the game deals a reproducible sequence of figures. The game neither reads
+ * nor writes the high score file, so any number of such games can run
+ * concurrently.
+ * @param mode Randomizer to use.
+ * @param seed Seed of the figure sequence.
+ * @return Pointer to the initialized GameInfo_t structure, NULL if memory
+ * ran out; nothing stays allocated then.
+ */
+GameInfo_t *game_init_seeded(PieceMode mode, uint64_t seed);
+
+/**
+ * @brief Restarts the game in place, keeping the field buffer, the figure
+ * slots and the high score, so a restart performs no allocations. The piece
+ * generator carries on with its sequence and the restart is recorded as a
+ * REPLAY_RESET input.
+ * @param game Pointer to the GameInfo_t structure.
+ */
+void reset_game(GameInfo_t *game);
+
 /**
  * @brief Frees the memory allocated for the GameInfo_t structure.
  * @param game Pointer to the GameInfo_t structure.
@@ -41,26 +72,36 @@ GameInfo_t *game_init();
 void free_game_init(GameInfo_t *game);
 
 /**
- * @brief Initializes the game field and returns a pointer to the 2D array
- * representing the field.
- * @return Pointer to the initialized game field.
+ * @brief Allocates a zeroed, cache-line aligned game field.
+ * @return Pointer to the first row of the initialized game field.
  */
-int **init_game_field();
+FieldRow *init_game_field();
 
 /**
  * @brief Frees the memory allocated for the game field.
  * @param field Pointer to the game field.
  */
-void free_game_field(int **field);
+void free_game_field(FieldRow *field);
 
 /**
  * @brief Initializes a new figure with the given coordinates and returns a
  * pointer to the Figure structure.
+ * @param figure_num Number of the figure, from 0 to FIGURES_COUNT - 1.
  * @param figure_x x-coordinate of the figure's position.
  * @param figure_y y-coordinate of the figure's position.
  * @return Pointer to the initialized Figure structure.
  */
-Figure *init_figure(int figure_x, int figure_y);
+Figure *init_figure(int figure_num, int figure_x, int figure_y);
+
+/**
+ * @brief Fills an existing Figure with the given shape at the given
+ * coordinates.
+ * @param figure Pointer to the Figure structure.
+ * @param figure_num Number of the figure, from 0 to FIGURES_COUNT - 1.
+ * @param figure_x x-coordinate of the figure's position.
+ * @param figure_y y-coordinate of the figure's position.
+ */
+void reset_figure(Figure *figure, int figure_num, int figure_x, int figure_y);
 
 /**
  * @brief Frees the memory allocated for the Figure structure.
@@ -75,6 +116,14 @@ void free_figure(Figure *figure);
  */
 void get_random_figure(Figure *figure);
 
+/**
+ * @brief Sets the rotation of the figure and fills its shape from the
+ * precomputed rotation table.
+ * @param figure Pointer to the Figure structure.
+ * @param rotation Index of the rotation, from 0 to FIGURE_ROTATIONS - 1.
+ */
+void set_figure_rotation(Figure *figure, int rotation);
+
 /**
  * @brief Places the current figure on the game field.
  * @param game Pointer to the GameInfo_t structure.
@@ -87,6 +136,55 @@ void place_figure_on_field(GameInfo_t *game);
  */
 void clear_figure_from_field(GameInfo_t *game);
 
+/**
+ * @brief Copies the game into a self-contained frame for rendering.
+ *
+ * The current figure is merged into the frame field, so the game itself is
+ * not modified.
+ *
+ * @param game Pointer to the GameInfo_t structure.
+ * @param frame Pointer to the Frame structure to fill.
+ */
+void snapshot_game(const GameInfo_t *game, Frame *frame);
+
+/**
+ * @brief Hashes everything that decides how the game continues.
+ *
+ * The high score is left out because it comes from disk, and so is the tick
+ * counter while the game is paused, because it is reset on resume anyway.
+ *
+ * @param game Pointer to the GameInfo_t structure.
+ * @return Hash of the game state.
+ */
+uint64_t hash_game(const GameInfo_t *game);
+
+/**
+ * @brief Serializes everything hash_game() covers, plus the high score and
+ * the piece generator, into a replay checkpoint.
+ *
+ * Every field row is stored as three 10-bit planes, one per bit of the cell
+ * color, and figures as their number, rotation and position.
+ *
+ * @param game Pointer to the GameInfo_t structure.
+ * @param state Buffer of at least TETRIS_CHECKPOINT_SIZE bytes.
+ * @return Number of bytes written.
+ */
+size_t checkpoint_game(const GameInfo_t *game, uint8_t *state);
+
+/**
+ * @brief Restores a game from a checkpoint written by checkpoint_game().
+ *
+ * Checkpoints come from replay files, so every value is checked: figures
+ * must lie inside the field without covering blocks, and level, speed,
+ * status and ticks must be ones the game can reach.
+ *
+ * @param game Pointer to the GameInfo_t structure, left untouched on failure.
+ * @param state Checkpoint bytes.
+ * @param size Number of checkpoint bytes.
+ * @return true if the checkpoint is well-formed.
+ */
+bool restore_game(GameInfo_t *game, const uint8_t *state, size_t size);
+
 /**
  * @brief Checks if there is a collision between the current figure and the game
  * field.
@@ -108,6 +206,13 @@ void drop_filled_lines(int i, GameInfo_t *game);
  */
 void erase_and_score(GameInfo_t *game);
 
+/**
+ * @brief Returns the points awarded for erasing lines at once.
+ * @param count Number of erased lines.
+ * @return Points to add to the score.
+ */
+int score_for_lines(int count);
+
 /**
  * @brief Checks if a line is filled with blocks.
  * @param i Index of the line to check.
@@ -144,6 +249,24 @@ void calculate_level(GameInfo_t *game);
  */
 void calculate_speed(GameInfo_t *game);
 
+/**
+ * @brief Returns the duration of one game tick at the current speed.
+ * @param game Pointer to the GameInfo_t structure.
+ * @return Tick duration in microseconds.
+ */
+long tick_interval_us(const GameInfo_t *game);
+
+/**
+ * @brief Returns how many ticks remain until gravity moves the figure down.
+ *
+ * Lets a frontend sleep until the next tick that changes the game instead of
+ * waking up on every tick.
+ *
+ * @param game Pointer to the GameInfo_t structure.
+ * @return Number of tick_game() calls until the figure falls, at least 1.
+ */
+int ticks_until_gravity(const GameInfo_t *game);
+
 /**
  * @brief Loads the highest score from a file.
  * @return Highest score.
@@ -157,7 +280,8 @@ int load_score();
 void update_max_score(GameInfo_t *game);
 
 /**
- * @brief Saves the highest score to a file.
+ * @brief Saves the highest score to a file, unless the game does not
+ * persist its score.
  * @param game Pointer to the GameInfo_t structure.
  */
 void save_max_score(const GameInfo_t *game);
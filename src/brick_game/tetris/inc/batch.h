@@ -0,0 +1,140 @@
+/**
+ * @file batch.h
+ * @brief Header file containing the batched tetris engine that steps many
+ * boards at once.
+ *
+ * The batch keeps every board in structure-of-arrays form: one array per
+ * state variable, indexed by board, and field rows stored row by row with
+ * the boards of a row next to each other. A step applies the rules of
+ * calculate_game() to all boards in lockstep, eight boards per AVX2 vector
+ * when the processor has it and one board at a time otherwise. Line clears
+ * and spawns, which happen at most once per board and step, always run per
+ * board.
+ *
+ * Every board follows the scalar engine exactly until its game is over. The
+ * step in which a board's game ends still applies its action like
+ * calculate_game() does; from the next step on the board is frozen until it
+ * is reset.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+#include "./backend.h"
+#include "./piece_generator.h"
+
+#define TETRIS_BATCH_LANES 8 /**< Boards stepped by one vector operation. */
+#define TETRIS_BATCH_WALL 8  /**< Wall bits right of column 0 in a row. */
+#define TETRIS_BATCH_TOP \
+  2 /**< Full rows above the field, the figure's row offset. */
+#define TETRIS_BATCH_ROWS                         \
+  (TETRIS_BATCH_TOP + FIELD_HEIGHT + FIGURE_SIZE - \
+   1) /**< Rows per board, the full rows below the field included. */
+#define TETRIS_BATCH_EMPTY_ROW                            \
+  (~(((1u << FIELD_WIDTH) - 1u)                           \
+     << TETRIS_BATCH_WALL)) /**< Row with only wall bits set. */
+
+/**
+ * @struct TetrisBatch
+ * @brief Structure representing a batch of tetris boards.
+ * @var TetrisBatch.count Number of boards.
+ * @var TetrisBatch.stride Number of boards rounded up to TETRIS_BATCH_LANES;
+ * the boards past count are frozen padding.
+ * @var TetrisBatch.simd Whether steps use AVX2, cleared to force the scalar
+ * path.
+ * @var TetrisBatch.rows Occupancy masks, TETRIS_BATCH_ROWS rows of stride
+ * boards. Field column j is bit j + TETRIS_BATCH_WALL, all other bits are
+ * walls; the rows outside the field are full.
+ * @var TetrisBatch.colors Cell colors of every board.
+ * @var TetrisBatch.piece Figure number of the falling figure.
+ * @var TetrisBatch.rotation Rotation of the falling figure.
+ * @var TetrisBatch.x x-coordinate of the falling figure.
+ * @var TetrisBatch.y y-coordinate of the falling figure.
+ * @var TetrisBatch.next_piece Figure number of the next figure.
+ * @var TetrisBatch.ticks_left Ticks left until gravity.
+ * @var TetrisBatch.status Game status, as GameInfo_t.status.
+ * @var TetrisBatch.score Current score.
+ * @var TetrisBatch.high_score Highest score of the board.
+ * @var TetrisBatch.level Current level.
+ * @var TetrisBatch.speed Current speed.
+ * @var TetrisBatch.over Whether the board's game has ended.
+ * @var TetrisBatch.generators Randomizer of every board.
+ */
+typedef struct TetrisBatch {
+  int count;
+  int stride;
+  int simd;
+  uint32_t *rows;
+  FieldRow (*colors)[FIELD_HEIGHT];
+  int32_t *piece;
+  int32_t *rotation;
+  int32_t *x;
+  int32_t *y;
+  int32_t *next_piece;
+  int32_t *ticks_left;
+  int32_t *status;
+  int32_t *score;
+  int32_t *high_score;
+  int32_t *level;
+  int32_t *speed;
+  int32_t *over;
+  PieceGenerator *generators;
+} TetrisBatch;
+
+/**
+ * @brief Allocates a batch of boards, each reset to an empty game with seed
+ * 0.
+ * @param count Number of boards.
+ * @return Pointer to the TetrisBatch structure, NULL on failure.
+ */
+TetrisBatch *tetris_batch_init(int count);
+
+/**
+ * @brief Frees a batch allocated by tetris_batch_init().
+ * @param batch Pointer to the TetrisBatch structure, may be NULL.
+ */
+void tetris_batch_free(TetrisBatch *batch);
+
+/**
+ * @brief Whether the processor can run the AVX2 step.
+ * @return true if tetris_batch_init() enables simd.
+ */
+bool tetris_batch_simd_available(void);
+
+/**
+ * @brief Starts a new game on a board, in the state game_init_seeded()
+ * followed by spawn_new() leaves a game.
+ * @param batch Pointer to the TetrisBatch structure.
+ * @param board Index of the board.
+ * @param mode Randomizer of the game.
+ * @param seed Seed of the game.
+ */
+void tetris_batch_reset(TetrisBatch *batch, int board, PieceMode mode,
+                        uint64_t seed);
+
+/**
+ * @brief Copies a scalar game into a board.
+ * @param batch Pointer to the TetrisBatch structure.
+ * @param board Index of the board.
+ * @param game Game to copy; a game that is over freezes the board.
+ */
+void tetris_batch_load(TetrisBatch *batch, int board, const GameInfo_t *game);
+
+/**
+ * @brief Copies a board into a scalar game.
+ * @param batch Pointer to the TetrisBatch structure.
+ * @param board Index of the board.
+ * @param game Game to overwrite, its generator included.
+ */
+void tetris_batch_store(const TetrisBatch *batch, int board, GameInfo_t *game);
+
+/**
+ * @brief Applies calculate_game() with one action to every board.
+ * @param batch Pointer to the TetrisBatch structure.
+ * @param actions UserAction_t of every board, count entries.
+ */
+void tetris_batch_step(TetrisBatch *batch, const uint8_t *actions);
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file bitboard.h
+ * @brief Header file containing the bitboard representation of the tetris
+ * game field.
+ *
+ * Each field row is stored as a 16-bit occupancy mask with the playable
+ * columns in the middle and permanently set wall bits on both sides, so a
+ * collision test is a shift and an AND per figure row and a full line is a
+ * single compare. Cell colors live in a separate byte plane.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#include "../../inc/defines.h"
+
+#define BITBOARD_WALL 3 /**< Number of wall bits left of column 0. */
+#define BITBOARD_FIELD_MASK                                 \
+  ((uint16_t)(((1u << FIELD_WIDTH) - 1u)                    \
+              << BITBOARD_WALL)) /**< Bits of the playable columns. */
+#define BITBOARD_EMPTY_ROW \
+  ((uint16_t)~BITBOARD_FIELD_MASK) /**< Row with only wall bits set. */
+#define BITBOARD_FULL_ROW ((uint16_t)0xFFFFu) /**< Completely filled row. */
+
+/**
+ * @struct Bitboard
+ * @brief Structure representing the game field as row masks and colors.
+ * @var Bitboard.rows Occupancy mask of every field row, walls included.
+ * @var Bitboard.colors Color of every field cell, 0 for an empty cell.
+ */
+typedef struct Bitboard {
+  uint16_t rows[FIELD_HEIGHT];
+  FieldRow colors[FIELD_HEIGHT];
+} Bitboard;
+
+/**
+ * @brief Resets the bitboard to an empty field.
+ * @param board Pointer to the Bitboard structure.
+ */
+void bitboard_clear(Bitboard *board);
+
+/**
+ * @brief Fills the bitboard from a game field.
+ * @param board Pointer to the Bitboard structure.
+ * @param field Game field to read.
+ */
+void bitboard_load_field(Bitboard *board, const FieldRow *field);
+
+/**
+ * @brief Writes the bitboard back into a game field.
+ * @param board Pointer to the Bitboard structure.
+ * @param field Game field to write.
+ */
+void bitboard_store_field(const Bitboard *board, FieldRow *field);
+
+/**
+ * @brief Builds per-row occupancy masks of a figure.
+ * @param figure Pointer to the Figure structure.
+ * @param masks Output array, bit j of masks[i] is set if figure cell [i][j]
+ * is filled.
+ */
+void bitboard_figure_masks(const Figure *figure, uint8_t masks[FIGURE_SIZE]);
+
+/**
+ * @brief Checks if a figure given by its row masks collides with the field
+ * or the field borders.
+ * @param board Pointer to the Bitboard structure.
+ * @param masks Figure row masks.
+ * @param x x-coordinate of the figure.
+ * @param y y-coordinate of the figure.
+ * @return 1 if there is a collision, 0 otherwise.
+ */
+int bitboard_collision(const Bitboard *board, const uint8_t masks[FIGURE_SIZE],
+                       int x, int y);
+
+/**
+ * @brief Places a figure on the bitboard, skipping cells outside the field.
+ * @param board Pointer to the Bitboard structure.
+ * @param figure Pointer to the Figure structure.
+ */
+void bitboard_place_figure(Bitboard *board, const Figure *figure);
+
+/**
+ * @brief Checks if a line is filled with blocks.
+ * @param board Pointer to the Bitboard structure.
+ * @param i Index of the line to check.
+ * @return 1 if the line is filled, 0 otherwise.
+ */
+int bitboard_check_filled_line(const Bitboard *board, int i);
+
+/**
+ * @brief Drops the lines above the given one by one row, the same way
+ * drop_filled_lines() does for the classic field.
+ * @param board Pointer to the Bitboard structure.
+ * @param i Index of the filled line.
+ */
+void bitboard_drop_filled_lines(Bitboard *board, int i);
+
+/**
+ * @brief Erases all filled lines.
+ * @param board Pointer to the Bitboard structure.
+ * @return Number of erased lines.
+ */
+int bitboard_erase_filled_lines(Bitboard *board);
+
+#endif
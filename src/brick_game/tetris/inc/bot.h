@@ -0,0 +1,96 @@
+/**
+ * @file bot.h
+ * @brief Header file containing the tetris autoplay bot.
+ *
+ * The bot tries every rotation and column of the falling figure, drops the
+ * figure straight down on a bitboard copy of the field and rates the result
+ * by cleared lines, aggregate column height, holes and bumpiness. With a
+ * search depth of two it then tries every placement of the next figure on
+ * the few best of those fields and rates them by the best result. Finally it
+ * steers the figure to the best placement with the same UserAction_t values
+ * a player sends to calculate_game(), one action per call.
+ */
+
+#ifndef BOT_H
+#define BOT_H
+
+#include "./backend.h"
+
+#define TETRIS_BOT_MAX_DEPTH 2 /**< Figures the bot can look ahead. */
+
+/**
+ * @struct TetrisBotWeights
+ * @brief Structure representing the weights of the placement rating.
+ * @var TetrisBotWeights.lines Weight of the lines cleared by the placement.
+ * @var TetrisBotWeights.height Weight of the sum of all column heights.
+ * @var TetrisBotWeights.holes Weight of the empty cells below a block.
+ * @var TetrisBotWeights.bumpiness Weight of the sum of the height
+ * differences of neighbouring columns.
+ */
+typedef struct TetrisBotWeights {
+  double lines;
+  double height;
+  double holes;
+  double bumpiness;
+} TetrisBotWeights;
+
+/**
+ * @struct TetrisBot
+ * @brief Structure representing the bot playing one game.
+ * @var TetrisBot.weights Weights of the placement rating.
+ * @var TetrisBot.depth Number of figures searched, 1 or
+ * TETRIS_BOT_MAX_DEPTH.
+ * @var TetrisBot.piece Number of the figure the target belongs to, counted
+ * by the game's generator.
+ * @var TetrisBot.rotation Target rotation of the falling figure.
+ * @var TetrisBot.x Target x-coordinate of the falling figure.
+ * @var TetrisBot.last_action Last steering action, IDLE if none.
+ * @var TetrisBot.last_x x-coordinate before the last steering action.
+ * @var TetrisBot.last_y y-coordinate before the last steering action.
+ * @var TetrisBot.last_rotation Rotation before the last steering action.
+ */
+typedef struct TetrisBot {
+  TetrisBotWeights weights;
+  int depth;
+  long piece;
+  int rotation;
+  int x;
+  UserAction_t last_action;
+  int last_x;
+  int last_y;
+  int last_rotation;
+} TetrisBot;
+
+/**
+ * @brief Sets up a bot with the default weights.
+ * @param bot Pointer to the TetrisBot structure.
+ * @param depth Number of figures to search, clamped to 1 and
+ * TETRIS_BOT_MAX_DEPTH.
+ */
+void tetris_bot_init(TetrisBot *bot, int depth);
+
+/**
+ * @brief Finds the best placement of the falling figure.
+ * @param bot Pointer to the TetrisBot structure.
+ * @param game Game to search, left unchanged.
+ * @param rotation Output rotation of the placement.
+ * @param x Output x-coordinate of the placement.
+ * @return false if the figure cannot be placed anywhere.
+ */
+bool tetris_bot_plan(const TetrisBot *bot, const GameInfo_t *game,
+                     int *rotation, int *x);
+
+/**
+ * @brief Chooses the next action for the game.
+ *
+ * A new figure is planned when it appears. The bot then rotates it, shifts
+ * it and drops it. A rotation with no effect is retried a row lower; if a
+ * shift or that fall has no effect, it drops the figure where it is.
+ *
+ * @param bot Pointer to the TetrisBot structure.
+ * @param game Game to play.
+ * @return Action for calculate_game(), IDLE unless the game is running.
+ */
+UserAction_t tetris_bot_action(TetrisBot *bot, const GameInfo_t *game);
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * @file figures.h
+ * @brief Header file containing the precomputed rotation table of all tetris
+ * figures.
+ */
+
+#ifndef FIGURES_H
+#define FIGURES_H
+
+#include <stdint.h>
+
+#include "../../inc/defines.h"
+
+/**
+ * @brief Row masks of every figure in every rotation.
+ *
+ * Bit j of figure_rows[num][rotation][i] is set if the cell [i][j] of the
+ * 5x5 figure matrix is filled. Rotation 0 is the spawn orientation, each next
+ * entry is the previous one turned clockwise the same way the game always
+ * turned figures, so a rotation is only an index change. The cell color of
+ * figure num is num + 1.
+ */
+static constexpr uint8_t figure_rows[FIGURES_COUNT][FIGURE_ROTATIONS]
+                                    [FIGURE_SIZE] = {
+    // 0. z
+    {{0x00, 0x00, 0x03, 0x06, 0x00},
+     {0x00, 0x00, 0x04, 0x06, 0x02},
+     {0x00, 0x00, 0x00, 0x03, 0x06},
+     {0x00, 0x00, 0x02, 0x03, 0x01}},
+    // 1. s
+    {{0x00, 0x00, 0x06, 0x03, 0x00},
+     {0x00, 0x00, 0x02, 0x06, 0x04},
+     {0x00, 0x00, 0x00, 0x06, 0x03},
+     {0x00, 0x00, 0x01, 0x03, 0x02}},
+    // 2. T
+    {{0x00, 0x00, 0x02, 0x07, 0x00},
+     {0x00, 0x00, 0x02, 0x06, 0x02},
+     {0x00, 0x00, 0x00, 0x07, 0x02},
+     {0x00, 0x00, 0x02, 0x03, 0x02}},
+    // 3. L
+    {{0x00, 0x00, 0x04, 0x07, 0x00},
+     {0x00, 0x00, 0x02, 0x02, 0x06},
+     {0x00, 0x00, 0x00, 0x07, 0x01},
+     {0x00, 0x00, 0x03, 0x02, 0x02}},
+    // 4. J
+    {{0x00, 0x00, 0x01, 0x07, 0x00},
+     {0x00, 0x00, 0x06, 0x02, 0x02},
+     {0x00, 0x00, 0x00, 0x07, 0x04},
+     {0x00, 0x00, 0x02, 0x02, 0x03}},
+    // 5. square
+    {{0x00, 0x00, 0x06, 0x06, 0x00},
+     {0x00, 0x00, 0x06, 0x06, 0x00},
+     {0x00, 0x00, 0x06, 0x06, 0x00},
+     {0x00, 0x00, 0x06, 0x06, 0x00}},
+    // 6. bar
+    {{0x00, 0x00, 0x0F, 0x00, 0x00},
+     {0x00, 0x04, 0x04, 0x04, 0x04},
+     {0x00, 0x00, 0x00, 0x0F, 0x00},
+     {0x00, 0x02, 0x02, 0x02, 0x02}},
+};
+
+#endif
@@ -7,6 +7,7 @@
 #ifndef FSM_T_H
 #define FSM_T_H
 
+#include "../../common/inc/game_clock.h"
 #include "backend.h"
 
 /**
@@ -15,6 +16,63 @@
  */
 void calculate_game(GameInfo_t* game);
 
+/**
+ * @brief Applies the pending user action without advancing the game clock.
+ *
+ * Lets an event-driven frontend react to input as soon as it arrives.
+ *
+ * @param game The game information.
+ */
+void process_action(GameInfo_t* game);
+
+/**
+ * @brief Advances the game clock by one tick, applying gravity when due.
+ * @param game The game information.
+ */
+void tick_game(GameInfo_t* game);
+
+/**
+ * @brief Counts down the ticks left, or restarts them while the game is
+ * paused or over.
+ * @param game The game information.
+ */
+void update_ticks(GameInfo_t* game);
+
+/**
+ * @brief Initializes a stopped game clock ticking at the game speed.
+ *
+ * The clock never holds more ticks than one gravity period, so a stalled
+ * frontend drops the figure by at most one row when it catches up.
+ *
+ * @param game The game information.
+ * @param clock The game clock.
+ */
+void init_game_clock(const GameInfo_t* game, GameClock* clock);
+
+/**
+ * @brief Runs every tick that is due on the game clock.
+ *
+ * Starts the clock when the game is running and stops it while the game is
+ * paused or over, so the game advances at a fixed rate independent of how
+ * often it is called.
+ *
+ * @param game The game information.
+ * @param clock The game clock.
+ * @param now_us Current time in microseconds.
+ * @return Number of ticks run.
+ */
+int advance_game(GameInfo_t* game, GameClock* clock, long long now_us);
+
+/**
+ * @brief Returns the time until gravity next moves the figure down.
+ * @param game The game information.
+ * @param clock The game clock.
+ * @param now_us Current time in microseconds.
+ * @return Microseconds until the figure falls, or -1 if the clock is stopped.
+ */
+long long time_to_gravity_us(const GameInfo_t* game, const GameClock* clock,
+                             long long now_us);
+
 /**
  * @brief Performs rotate action.
  * @param game The game information.
@@ -57,12 +115,67 @@ void action_pause(GameInfo_t* game);
  */
 void action_start(GameInfo_t* game);
 
+/**
+ * @brief Maps a terminal key code to a user action.
+ * @param ch Key code returned by getch().
+ * @return The user action, IDLE for an unknown key.
+ */
+UserAction_t key_to_action(int ch);
+
 /**
  * @brief Gets the user action.
  * @param game The game information.
  */
 void get_user_action(GameInfo_t* game, int ch);
 
+/**
+ * @brief Applies a user action at once, ignoring moves while paused.
+ * @param game The game information.
+ * @param action The user action.
+ */
+void apply_user_action(GameInfo_t* game, UserAction_t action);
+
+/**
+ * @brief Starts recording a fresh game into a replay.
+ *
+ * Call it right after game_init() and the first spawn_new(), before any
+ * input or tick, because a replay starts from exactly that state.
+ *
+ * @param game The game information.
+ * @param replay Replay to record into, owned by the caller.
+ */
+void record_game(GameInfo_t* game, Replay* replay);
+
+/**
+ * @brief Stops recording and stores the final state hash in the replay.
+ * @param game The game information.
+ */
+void finish_recording(GameInfo_t* game);
+
+/**
+ * @brief Re-simulates a recorded tetris session from its seed as fast as
+ * possible, ignoring the checkpoints.
+ * @param replay Recorded session.
+ * @return Hash of the final state, to compare with replay->final_hash, or 0
+ * if memory ran out.
+ */
+uint64_t replay_tetris(const Replay* replay);
+
+/**
+ * @brief Rebuilds the state of a recorded tetris session at a given step.
+ *
+ * Restores the last checkpoint at or before the step and re-simulates only
+ * the inputs after it, so seeking late into a long session costs no more
+ * than one checkpoint interval of simulation.
+ *
+ * @param replay Recorded session.
+ * @param step Number of engine steps to seek to, clamped to replay->steps.
+ * The inputs recorded at that step are applied.
+ * @return Game in the recorded state, free it with free_game_init(); NULL
+ * if memory ran out.
+ */
+GameInfo_t* seek_tetris(const Replay* replay, unsigned long step);
+
 /**
  * @brief Moves the current figure down.
  * @param game The game information.
@@ -88,11 +201,11 @@ void move_right(GameInfo_t* game);
 void move_left(GameInfo_t* game);
 
 /**
- * @brief Rotates the current figure.
+ * @brief Rotates the current figure in place by switching to its next entry
+ * in the rotation table.
  * @param game The game information.
- * @return Pointer to the rotated figure.
  */
-Figure* rotate(GameInfo_t* game);
+void rotate(GameInfo_t* game);
 
 /**
  * @brief Plants the current figure on the game board.
@@ -101,7 +214,8 @@ Figure* rotate(GameInfo_t* game);
 void plant_figure(GameInfo_t* game);
 
 /**
- * @brief Spawns next figure and create new next figure preview.
+ * @brief Spawns next figure and refills the freed slot with a new next
+ * figure preview, without allocating.
  * @param game The game information.
  */
 void spawn_new(GameInfo_t* game);
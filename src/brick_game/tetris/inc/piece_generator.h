@@ -0,0 +1,97 @@
+/**
+ * @file piece_generator.h
+ * @brief Header file containing the per-game tetris piece generator.
+ *
+ * The generator decides which figure comes next. It owns its random state,
+ * so games never share a sequence through global state and a game started
+ * with the same mode and seed always deals the same pieces.
+ */
+
+#ifndef PIECE_GENERATOR_H
+#define PIECE_GENERATOR_H
+
+#include <stdint.h>
+
+#include "../../common/inc/rng.h"
+#include "../../inc/defines.h"
+
+#define PIECE_HISTORY 4 /**< Number of recent pieces the TGM mode avoids. */
+#define PIECE_TGM_ROLLS 6 /**< Rerolls the TGM mode makes before giving up. */
+#define PIECE_GENERATOR_STATE_SIZE                                     \
+  (4 * 8 + 8 + 1 + FIGURES_COUNT + 1 + PIECE_HISTORY + \
+   8) /**< Bytes written by piece_generator_save(). */
+
+/**
+ * @brief Enumeration of piece randomizers.
+ * - PIECES_UNIFORM: Every figure is equally likely on every draw.
+ * - PIECES_BAG: All seven figures are dealt in a shuffled bag before any
+ *   repeats.
+ * - PIECES_TGM: A uniform draw rerolled while it matches one of the last
+ *   four pieces; the first piece is never s, z or square.
+ */
+typedef enum { PIECES_UNIFORM, PIECES_BAG, PIECES_TGM } PieceMode;
+
+/**
+ * @struct PieceGenerator
+ * @brief Structure representing the randomizer state of one game.
+ * @var PieceGenerator.rng Random state.
+ * @var PieceGenerator.seed Seed the sequence was started with.
+ * @var PieceGenerator.mode Randomizer in use.
+ * @var PieceGenerator.bag Figures of the current bag, dealt from the end.
+ * @var PieceGenerator.bag_left Number of figures not yet dealt from the bag.
+ * @var PieceGenerator.history Recently dealt figures, newest first.
+ * @var PieceGenerator.dealt Number of figures dealt so far.
+ */
+typedef struct PieceGenerator {
+  Rng rng;
+  uint64_t seed;
+  PieceMode mode;
+  int bag[FIGURES_COUNT];
+  int bag_left;
+  int history[PIECE_HISTORY];
+  long dealt;
+} PieceGenerator;
+
+/**
+ * @brief Resets the generator to the start of the sequence given by the mode
+ * and the seed.
+ * @param generator Pointer to the PieceGenerator structure.
+ * @param mode Randomizer to use.
+ * @param seed Seed of the sequence.
+ */
+void piece_generator_init(PieceGenerator *generator, PieceMode mode,
+                          uint64_t seed);
+
+/**
+ * @brief Deals the next figure.
+ * @param generator Pointer to the PieceGenerator structure.
+ * @return Figure number from 0 to FIGURES_COUNT - 1.
+ */
+int piece_generator_next(PieceGenerator *generator);
+
+/**
+ * @brief Serializes the generator for a replay checkpoint.
+ * @param generator Pointer to the PieceGenerator structure.
+ * @param out Buffer of at least PIECE_GENERATOR_STATE_SIZE bytes.
+ * @return Pointer past the written bytes.
+ */
+uint8_t *piece_generator_save(const PieceGenerator *generator, uint8_t *out);
+
+/**
+ * @brief Restores a generator written by piece_generator_save().
+ * @param generator Pointer to the PieceGenerator structure, left untouched
+ * on failure.
+ * @param in PIECE_GENERATOR_STATE_SIZE bytes to read.
+ * @return true if the bytes describe a valid generator.
+ */
+bool piece_generator_restore(PieceGenerator *generator, const uint8_t *in);
+
+/**
+ * @brief Parses a randomizer name.
+ * @param name One of "uniform", "bag" or "tgm".
+ * @param mode Output mode, left untouched on failure.
+ * @return true if the name is known.
+ */
+bool piece_mode_from_name(const char *name, PieceMode *mode);
+
+#endif
@@ -0,0 +1,129 @@
+#include "./inc/piece_generator.h"
+
+#include <string.h>
+
+#include "../common/inc/replay.h"
+
+#define PIECE_Z 0      /**< Figure number of the z figure. */
+#define PIECE_S 1      /**< Figure number of the s figure. */
+#define PIECE_SQUARE 5 /**< Figure number of the square figure. */
+
+static void refill_bag(PieceGenerator *generator) {
+  for (int i = 0; i < FIGURES_COUNT; i++) generator->bag[i] = i;
+  for (int i = FIGURES_COUNT - 1; i > 0; i--) {
+    int j = (int)rng_below(&generator->rng, (uint32_t)(i + 1));
+    int tmp = generator->bag[i];
+    generator->bag[i] = generator->bag[j];
+    generator->bag[j] = tmp;
+  }
+  generator->bag_left = FIGURES_COUNT;
+}
+
+static int in_history(const PieceGenerator *generator, int piece) {
+  for (int i = 0; i < PIECE_HISTORY; i++) {
+    if (generator->history[i] == piece) return 1;
+  }
+  return 0;
+}
+
+static int next_tgm(PieceGenerator *generator) {
+  int piece = 0;
+  if (generator->dealt == 0) {
+    do {
+      piece = (int)rng_below(&generator->rng, FIGURES_COUNT);
+    } while (piece == PIECE_Z || piece == PIECE_S || piece == PIECE_SQUARE);
+  } else {
+    for (int roll = 0; roll < PIECE_TGM_ROLLS; roll++) {
+      piece = (int)rng_below(&generator->rng, FIGURES_COUNT);
+      if (!in_history(generator, piece)) break;
+    }
+  }
+  memmove(&generator->history[1], &generator->history[0],
+          (PIECE_HISTORY - 1) * sizeof(generator->history[0]));
+  generator->history[0] = piece;
+  return piece;
+}
+
+void piece_generator_init(PieceGenerator *generator, PieceMode mode,
+                          uint64_t seed) {
+  rng_seed(&generator->rng, seed);
+  generator->seed = seed;
+  generator->mode = mode;
+  for (int i = 0; i < FIGURES_COUNT; i++) generator->bag[i] = i;
+  generator->bag_left = 0;
+  generator->history[0] = PIECE_Z;
+  generator->history[1] = PIECE_S;
+  generator->history[2] = PIECE_S;
+  generator->history[3] = PIECE_Z;
+  generator->dealt = 0;
+}
+
+int piece_generator_next(PieceGenerator *generator) {
+  int piece;
+  if (generator->mode == PIECES_BAG) {
+    if (generator->bag_left == 0) refill_bag(generator);
+    piece = generator->bag[--generator->bag_left];
+  } else if (generator->mode == PIECES_TGM) {
+    piece = next_tgm(generator);
+  } else {
+    piece = (int)rng_below(&generator->rng, FIGURES_COUNT);
+  }
+  generator->dealt++;
+  return piece;
+}
+
+uint8_t *piece_generator_save(const PieceGenerator *generator, uint8_t *out) {
+  for (int i = 0; i < 4; i++) out = replay_put(out, generator->rng.s[i], 8);
+  out = replay_put(out, generator->seed, 8);
+  out = replay_put(out, generator->mode, 1);
+  for (int i = 0; i < FIGURES_COUNT; i++) {
+    out = replay_put(out, generator->bag[i], 1);
+  }
+  out = replay_put(out, generator->bag_left, 1);
+  for (int i = 0; i < PIECE_HISTORY; i++) {
+    out = replay_put(out, generator->history[i], 1);
+  }
+  return replay_put(out, generator->dealt, 8);
+}
+
+bool piece_generator_restore(PieceGenerator *generator, const uint8_t *in) {
+  PieceGenerator restored;
+  uint64_t value = 0;
+  bool valid = true;
+  for (int i = 0; i < 4; i++) in = replay_get(in, &restored.rng.s[i], 8);
+  in = replay_get(in, &restored.seed, 8);
+  in = replay_get(in, &value, 1);
+  valid = valid && value <= PIECES_TGM;
+  restored.mode = (PieceMode)value;
+  for (int i = 0; i < FIGURES_COUNT; i++) {
+    in = replay_get(in, &value, 1);
+    valid = valid && value < FIGURES_COUNT;
+    restored.bag[i] = (int)value;
+  }
+  in = replay_get(in, &value, 1);
+  valid = valid && value <= FIGURES_COUNT;
+  restored.bag_left = (int)value;
+  for (int i = 0; i < PIECE_HISTORY; i++) {
+    in = replay_get(in, &value, 1);
+    valid = valid && value < FIGURES_COUNT;
+    restored.history[i] = (int)value;
+  }
+  replay_get(in, &value, 8);
+  restored.dealt = (long)value;
+  if (valid) *generator = restored;
+  return valid;
+}
+
+bool piece_mode_from_name(const char *name, PieceMode *mode) {
+  bool known = true;
+  if (strcmp(name, "uniform") == 0) {
+    *mode = PIECES_UNIFORM;
+  } else if (strcmp(name, "bag") == 0) {
+    *mode = PIECES_BAG;
+  } else if (strcmp(name, "tgm") == 0) {
+    *mode = PIECES_TGM;
+  } else {
+    known = false;
+  }
+  return known;
+}
@@ -1,5 +1,54 @@
 #include "./inc/frontend.h"
 
+/** Overlay text currently printed over the game field. */
+typedef enum {
+  OVERLAY_NONE,
+  OVERLAY_PAUSE,
+  OVERLAY_GAMEOVER,
+  OVERLAY_WIN
+} Overlay;
+
+static int field_shadow[FIELD_HEIGHT][FIELD_WIDTH];
+static bool field_shadow_valid = false;
+static int next_shadow[FIGURE_SIZE][FIGURE_SIZE];
+static bool next_shadow_valid = false;
+
+static bool help_shown = false;
+static int shown_level = -1;
+static int shown_score = -1;
+static int shown_high_score = -1;
+static Overlay shown_overlay = OVERLAY_NONE;
+
+static void draw_cell(WINDOW *win, int row, int col, int value) {
+  wattron(win, COLOR_PAIR(value));
+  mvwaddch(win, 1 + row, 1 + col * WIDTH_FACTOR, ' ');
+  waddch(win, ' ');
+  wattroff(win, COLOR_PAIR(value));
+}
+
+static void print_label(int y, const char *label, int value, int *shown) {
+  if (*shown == value) return;
+  move(y, 0);
+  clrtoeol();
+  mvprintw(y, 0, "%s: %d", label, value);
+  *shown = value;
+}
+
+static void show_overlay(Overlay overlay, const char *first,
+                         const char *second, const char *third) {
+  if (shown_overlay == overlay) return;
+  // Lines are padded so that a longer text of the previous overlay is erased.
+  mvprintw(11, 22, "%-11s", first);
+  mvprintw(12, 22, "%-11s", second);
+  if (third) {
+    mvprintw(13, 22, "%-11s", third);
+  } else if (shown_overlay != OVERLAY_NONE) {
+    mvprintw(13, 22, "%-11s", "");
+  }
+  refresh();
+  shown_overlay = overlay;
+}
+
 WINDOW *create_newwin(int height, int width, int starty, int startx) {
   WINDOW *main_win;
   main_win = newwin(height, width, starty, startx);
@@ -17,6 +66,34 @@ void win_init() {
   keypad(stdscr, TRUE);
 }
 
+bool wait_for_input(int timeout_ms, int wake_fd) {
+  struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+  if (poll(fds, 2, timeout_ms) <= 0) return false;
+  if (fds[1].revents & POLLIN) {
+    char buf[64];
+    while (read(wake_fd, buf, sizeof(buf)) > 0) {
+    }
+  }
+  return fds[0].revents & POLLIN;
+}
+
+bool open_wake_pipe(int fds[2]) {
+  if (pipe(fds) != 0) return false;
+  for (int i = 0; i < 2; i++) fcntl(fds[i], F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+void notify_wake_pipe(int fd) {
+  char byte = 0;
+  // A full pipe already holds a pending wakeup, so a failed write is fine.
+  if (write(fd, &byte, 1) < 0) return;
+}
+
+void close_wake_pipe(int fds[2]) {
+  close(fds[0]);
+  close(fds[1]);
+}
+
 void color_init() {
   start_color();
   init_pair(1, COLOR_WHITE, COLOR_WHITE);
@@ -28,79 +105,88 @@ void color_init() {
   init_pair(7, COLOR_CYAN, COLOR_CYAN);
 }
 
-void game_field_text(GameInfo_t *game) {
-  int l_align = 0;
+void game_field_text(const Frame *frame) {
   int r_align = 45;
+  int old_level = shown_level;
+  int old_score = shown_score;
+  int old_high_score = shown_high_score;
 
-  move(3, l_align);
-  clrtoeol();
-  move(5, l_align);
-  clrtoeol();
-  move(7, l_align);
-  clrtoeol();
-
-  mvprintw(3, l_align, "LEVEL: %d", game->level);
-  mvprintw(5, l_align, "SCORE: %d", game->score);
-  mvprintw(7, l_align, "MAX SCORE: %d", game->high_score);
-  mvprintw(3, r_align, "LEFT ARROW  : MOVE LEFT");
-  mvprintw(5, r_align, "RIGHT ARROW : MOVE RIGHT");
-  mvprintw(7, r_align, "DOWN ARROW  : MOVE DOWN");
-  mvprintw(9, r_align, "UP ARROW    : MOVE UP/ROTATE");
-  mvprintw(11, r_align, "X : ACTION");
-  mvprintw(13, r_align, "P : PAUSE");
-  mvprintw(15, r_align, "Q : EXIT");
+  print_label(3, "LEVEL", frame->level, &shown_level);
+  print_label(5, "SCORE", frame->score, &shown_score);
+  print_label(7, "MAX SCORE", frame->high_score, &shown_high_score);
+  if (!help_shown) {
+    mvprintw(3, r_align, "LEFT ARROW  : MOVE LEFT");
+    mvprintw(5, r_align, "RIGHT ARROW : MOVE RIGHT");
+    mvprintw(7, r_align, "DOWN ARROW  : MOVE DOWN");
+    mvprintw(9, r_align, "UP ARROW    : MOVE UP/ROTATE");
+    mvprintw(11, r_align, "X : ACTION");
+    mvprintw(13, r_align, "P : PAUSE");
+    mvprintw(15, r_align, "Q : EXIT");
+  }
 
-  refresh();
+  if (!help_shown || old_level != shown_level || old_score != shown_score ||
+      old_high_score != shown_high_score) {
+    refresh();
+  }
+  help_shown = true;
 }
 
-void draw_game_field(WINDOW *win, GameInfo_t *game) {
-  box(win, 0, 0);
+void draw_game_field(WINDOW *win, const Frame *frame) {
+  bool changed = false;
+  if (shown_overlay != OVERLAY_NONE) {
+    // The overlay text lives in stdscr on top of this window, so the whole
+    // window has to be copied to the screen again to cover it.
+    touchwin(win);
+    shown_overlay = OVERLAY_NONE;
+    changed = true;
+  }
   for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++)
-      for (int k = 0; k < 2; k++) {
-        wattron(win, COLOR_PAIR(game->field[i][j]));
-        mvwaddch(win, 1 + i, 1 + j * WIDTH_FACTOR + k, ' ');
-        wattroff(win, COLOR_PAIR(game->field[i][j]));
-      }
-  wrefresh(win);
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      int value = frame->field[i][j];
+      if (field_shadow_valid && field_shadow[i][j] == value) continue;
+      draw_cell(win, i, j, value);
+      field_shadow[i][j] = value;
+      changed = true;
+    }
+  field_shadow_valid = true;
+  if (changed) wrefresh(win);
 }
 
-void draw_next_figure(WINDOW *win, GameInfo_t *game) {
+void draw_next_figure(WINDOW *win, const Frame *frame) {
+  bool changed = false;
   for (int i = 0; i < FIGURE_SIZE; i++)
-    for (int j = 0; j < FIGURE_SIZE; j++)
-      for (int k = 0; k < 2; k++) {
-        wattron(win, COLOR_PAIR(game->next_figure->figure[i][j]));
-        mvwaddch(win, 1 + i, 1 + j * WIDTH_FACTOR + k, ' ');
-        wattroff(win, COLOR_PAIR(game->next_figure->figure[i][j]));
-      }
-  wrefresh(win);
+    for (int j = 0; j < FIGURE_SIZE; j++) {
+      int value = frame->next[i][j];
+      if (next_shadow_valid && next_shadow[i][j] == value) continue;
+      draw_cell(win, i, j, value);
+      next_shadow[i][j] = value;
+      changed = true;
+    }
+  next_shadow_valid = true;
+  if (changed) wrefresh(win);
 }
 
 void pause_text() {
-  mvprintw(11, 22, "Press ENTER");
-  mvprintw(12, 22, "to Start");
-  refresh();
+  show_overlay(OVERLAY_PAUSE, "Press ENTER", "to Start", NULL);
 }
 
 void gameover_text() {
-  mvprintw(11, 22, "GAME OVER");
-  mvprintw(12, 22, "Press ENTER");
-  mvprintw(13, 22, "to Restart");
-  refresh();
+  show_overlay(OVERLAY_GAMEOVER, "GAME OVER", "Press ENTER", "to Restart");
 }
 
 void win_text() {
-  mvprintw(11, 22, "YOU WIN!");
-  mvprintw(12, 22, "Press ENTER");
-  mvprintw(13, 22, "to Restart");
-  refresh();
+  show_overlay(OVERLAY_WIN, "YOU WIN!", "Press ENTER", "to Restart");
 }
 
 void clear_win(WINDOW *win) {
+  bool changed = false;
   for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++)
-      for (int k = 0; k < 2; k++) {
-        mvwaddch(win, 1 + i, 1 + j * WIDTH_FACTOR + k, ' ');
-      }
-  wrefresh(win);
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      if (field_shadow_valid && field_shadow[i][j] == 0) continue;
+      draw_cell(win, i, j, 0);
+      field_shadow[i][j] = 0;
+      changed = true;
+    }
+  field_shadow_valid = true;
+  if (changed) wrefresh(win);
 }
@@ -8,6 +8,9 @@
 #define FRONTEND_H
 
 #include <ncurses.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include "../../../brick_game/inc/defines.h"
 #include "../../../brick_game/tetris/inc/backend.h"
@@ -45,9 +48,9 @@ WINDOW *create_newwin(int height, int width, int starty, int startx);
  *
  * This function displays game text such as level, score, controls etc.
  *
- * @param game Pointer to the GameInfo_t struct containing the game information.
+ * @param frame Pointer to the Frame struct containing the game snapshot.
  */
-void game_field_text(GameInfo_t *game);
+void game_field_text(const Frame *frame);
 
 /**
  * @brief Draws the game field in the specified window.
@@ -55,9 +58,9 @@ void game_field_text(GameInfo_t *game);
  * This function draws the game field in the specified ncurses window.
  *
  * @param win Pointer to the ncurses window.
- * @param game Pointer to the GameInfo_t struct containing the game information.
+ * @param frame Pointer to the Frame struct containing the game snapshot.
  */
-void draw_game_field(WINDOW *win, GameInfo_t *game);
+void draw_game_field(WINDOW *win, const Frame *frame);
 
 /**
  * @brief Draws the next figure in the specified window.
@@ -65,9 +68,9 @@ void draw_game_field(WINDOW *win, GameInfo_t *game);
  * This function draws the next figure in the specified ncurses window.
  *
  * @param win Pointer to the ncurses window.
- * @param game Pointer to the GameInfo_t struct containing the game information.
+ * @param frame Pointer to the Frame struct containing the game snapshot.
  */
-void draw_next_figure(WINDOW *win, GameInfo_t *game);
+void draw_next_figure(WINDOW *win, const Frame *frame);
 
 /**
  * @brief Displays the pause text in the game.
@@ -102,6 +105,39 @@ void win_text();
  */
 void clear_win(WINDOW *win);
 
+/**
+ * @brief Sleeps until a key is pressed, the wake pipe is written or the
+ * timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds, or -1 to wait for
+ * input only.
+ * @param wake_fd Read end of a wake pipe, drained on wakeup, or -1.
+ * @return true if input is ready to be read with getch().
+ */
+bool wait_for_input(int timeout_ms, int wake_fd = -1);
+
+/**
+ * @brief Creates a non-blocking pipe used to wake the frontend loop.
+ *
+ * @param fds Receives the read and write ends of the pipe.
+ * @return true on success.
+ */
+bool open_wake_pipe(int fds[2]);
+
+/**
+ * @brief Wakes a loop waiting on the read end of a wake pipe.
+ *
+ * @param fd Write end of the wake pipe.
+ */
+void notify_wake_pipe(int fd);
+
+/**
+ * @brief Closes both ends of a wake pipe.
+ *
+ * @param fds Read and write ends of the pipe.
+ */
+void close_wake_pipe(int fds[2]);
+
 /**
  * @brief Displays the menu to choose game.
  *
@@ -113,17 +149,21 @@ int show_menu();
 /**
  * @brief Main tetris gameloop.
  *
- * This function starts tetris game.
+ * This function starts tetris game. When BRICKGAME_SHM is set, the game is
+ * shared under that name and does not start if it cannot be.
  *
+ * @return false if the game could not be shared, true otherwise.
  */
-void game_loop_tetris();
+bool game_loop_tetris();
 
 /**
  * @brief Main snake gameloop.
  *
- * This function starts snake game.
+ * This function starts snake game. When BRICKGAME_SHM is set, the game is
+ * shared under that name and does not start if it cannot be.
  *
+ * @return false if the game could not be shared, true otherwise.
  */
-void game_loop_snake();
+bool game_loop_snake();
 
 #endif
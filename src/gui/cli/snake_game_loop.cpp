@@ -1,81 +1,129 @@
+#include "../../brick_game/common/inc/game_thread.h"
 #include "../../brick_game/snake/controller/inc/game_controller.h"
 #include "inc/frontend.h"
 
 #include <ncurses.h>
 
+#include <cstdlib>
+
 s21::GameModel game_model;
 s21::GameController GameController(&game_model);
 
-void game_loop_snake() {
+bool game_loop_snake() {
+  const char *shared_name = std::getenv("BRICKGAME_SHM");
+  SharedSession *shared =
+      shared_name ? shared_session_create(shared_name, SHARED_SNAKE) : NULL;
+  if (shared_name && shared == NULL) return false;
+  const char *replay_path = std::getenv("BRICKGAME_REPLAY");
+  Replay replay;
+  if (replay_path) {
+    replay_init(&replay, REPLAY_SNAKE, 0, game_model.GetSeed());
+    game_model.SetRecorder(&replay);
+  }
   GameController.userInput(Start, false);
   WINDOW *main_win = create_newwin(FIELD_HEIGHT + FIELD_BORDERS,
                                    FIELD_WIDTH * WIDTH_FACTOR + FIELD_BORDERS,
                                    FIELD_START_Y, FIELD_START_X);
   mvprintw(1, 23, "S N A K E");
+
+  int wake[2] = {-1, -1};
+  open_wake_pipe(wake);
+  s21::GameThread game_thread(
+      [](const InputEvent &event) {
+        GameController.userInput(event.action, event.hold);
+      },
+      [](long long now_us) {
+        (void)now_us;
+        game_model.Advance();
+        int left_ms = game_model.GetTimeToUpdate();
+        return left_ms < 0 ? -1LL : left_ms * 1000LL;
+      },
+      [](Frame *frame) { game_model.Snapshot(frame); },
+      [&]() { notify_wake_pipe(wake[1]); });
+  game_thread.Share(shared);
+  game_thread.Start();
+
   bool running = true;
   bool act = false;
+  GameState last_state = Exit;
+  unsigned long long drawn = 0;
   while (running) {
-    int ch = getch();
-    switch (ch) {
-    case KEY_LEFT:
-      GameController.userInput(Left, false);
-      break;
-    case KEY_RIGHT:
-      GameController.userInput(Right, false);
-      break;
-    case KEY_UP:
-      GameController.userInput(Up, false);
-      break;
-    case KEY_DOWN:
-      GameController.userInput(Down, false);
-      break;
-    case 'x':
-    case 'X':
-      act = !act;
-      GameController.userInput(Action, act);
-      break;
-    case 'p':
-    case 'P':
-      GameController.userInput(Pause, false);
-      break;
-    case 'q':
-    case 'Q':
-      GameController.userInput(Terminate, false);
-      running = false;
-      break;
-    case '\n':
-      GameController.userInput(Start, false);
-      break;
-    default:
-      break;
+    int ch;
+    while (running && (ch = getch()) != ERR) {
+      switch (ch) {
+      case KEY_LEFT:
+        game_thread.Post(Left, false);
+        break;
+      case KEY_RIGHT:
+        game_thread.Post(Right, false);
+        break;
+      case KEY_UP:
+        game_thread.Post(Up, false);
+        break;
+      case KEY_DOWN:
+        game_thread.Post(Down, false);
+        break;
+      case 'x':
+      case 'X':
+        act = !act;
+        game_thread.Post(Action, act);
+        break;
+      case 'p':
+      case 'P':
+        game_thread.Post(Pause, false);
+        break;
+      case 'q':
+      case 'Q':
+        game_thread.Post(Terminate, false);
+        running = false;
+        break;
+      case '\n':
+        game_thread.Post(Start, false);
+        break;
+      default:
+        break;
+      }
     }
 
     if (!running) {
       break;
     }
 
-    GameInfo_t game_info = game_model.UpdateCurrentState();
+    const Frame *frame = game_thread.Latest();
+    if (frame->sequence != drawn) {
+      drawn = frame->sequence;
+      GameState state = static_cast<GameState>(frame->state);
+      // A process controlling the game through BRICKGAME_SHM can quit it.
+      if (state == Exit) break;
 
-    game_field_text(&game_info);
-    draw_game_field(main_win, &game_info);
-
-    GameState state = game_model.GetGameState();
-    if (state == Paused) {
-      pause_text();
-    } else if (state == GameOver) {
-      clear_win(main_win);
-      gameover_text();
-      if (ch == '\n') {
-        GameController.userInput(Start, false);
+      if (state == Running || state != last_state) {
+        game_field_text(frame);
+        draw_game_field(main_win, frame);
       }
-    } else if (state == Win) {
-      clear_win(main_win);
-      win_text();
-      if (ch == '\n') {
-        GameController.userInput(Start, false);
+      last_state = state;
+
+      if (state == Paused) {
+        pause_text();
+      } else if (state == GameOver) {
+        clear_win(main_win);
+        gameover_text();
+      } else if (state == Win) {
+        clear_win(main_win);
+        win_text();
       }
     }
-    napms(50);
+
+    wait_for_input(-1, wake[0]);
+  }
+  game_thread.Stop();
+  shared_session_destroy(shared, shared_name);
+  close_wake_pipe(wake);
+  if (replay_path) {
+    replay.final_hash = game_model.StateHash();
+    game_model.SetRecorder(nullptr);
+    replay_save(&replay, replay_path);
+    replay_free(&replay);
   }
   delwin(main_win);
+  return true;
 }
@@ -1,8 +1,18 @@
+#include <cstdlib>
+
+#include "../../brick_game/common/inc/game_thread.h"
 #include "inc/frontend.h"
 
-void game_loop_tetris() {
-  struct timespec sp_start, sp_end, ts1, ts2 = {0, 0};
+bool game_loop_tetris() {
   GameInfo_t* game = game_init();
+  if (game == NULL) return true;
+  const char* shared_name = std::getenv("BRICKGAME_SHM");
+  SharedSession* shared =
+      shared_name ? shared_session_create(shared_name, SHARED_TETRIS) : NULL;
+  if (shared_name && shared == NULL) {
+    free_game_init(game);
+    return false;
+  }
   WINDOW* main_win;
   WINDOW* next_figure_win;
   main_win = create_newwin(FIELD_HEIGHT + FIELD_BORDERS,
@@ -12,38 +22,73 @@ void game_loop_tetris() {
                                   NEXT_FIELD_Y, NEXT_FIELD_X);
   mvprintw(1, 22, "T E T R I S");
   spawn_new(game);
-  while (game->status != Terminate) {
-    clock_gettime(CLOCK_MONOTONIC, &sp_start);
-    int ch = getch();
-    get_user_action(game, ch);
-    calculate_game(game);
-    if (game->status != Pause && game->status != GAMEOVER) {
-      place_figure_on_field(game);
-      game_field_text(game);
-      draw_game_field(main_win, game);
-      clear_figure_from_field(game);
-      draw_next_figure(next_figure_win, game);
-      refresh();
-    } else if (game->status == Pause) {
-      game_field_text(game);
-      draw_game_field(main_win, game);
-      clear_win(main_win);
-      pause_text();
-    } else if (game->status == GAMEOVER) {
-      clear_win(main_win);
-      gameover_text();
-    }
-    if (game->status == RESET) {
-      free_game_init(game);
-      game = game_init();
-      game->status = Start;
+  const char* replay_path = std::getenv("BRICKGAME_REPLAY");
+  Replay replay;
+  if (replay_path) record_game(game, &replay);
+  GameClock clock;
+  init_game_clock(game, &clock);
+
+  int wake[2] = {-1, -1};
+  open_wake_pipe(wake);
+  s21::GameThread game_thread(
+      [&](const InputEvent& event) {
+        apply_user_action(game, event.action);
+        if (game->status == RESET) {
+          reset_game(game);
+          apply_user_action(game, Start);
+          init_game_clock(game, &clock);
+        }
+      },
+      [&](long long now_us) {
+        advance_game(game, &clock, now_us);
+        return time_to_gravity_us(game, &clock, now_us);
+      },
+      [&](Frame* frame) { snapshot_game(game, frame); },
+      [&]() { notify_wake_pipe(wake[1]); });
+  game_thread.Share(shared);
+  game_thread.Start();
+
+  bool running = true;
+  unsigned long long drawn = 0;
+  while (running) {
+    int ch;
+    while ((ch = getch()) != ERR) {
+      UserAction_t action = key_to_action(ch);
+      if (action == IDLE) continue;
+      game_thread.Post(action, false);
+      if (action == Terminate) running = false;
     }
-    clock_gettime(CLOCK_MONOTONIC, &sp_end);
-    if (sp_end.tv_sec - sp_start.tv_sec <= 0 &&
-        (ts2.tv_nsec = 33000000 - game->speed -
-                       (sp_end.tv_nsec - sp_start.tv_nsec)) > 0) {
-      nanosleep(&ts2, &ts1);
+    if (!running) break;
+
+    const Frame* frame = game_thread.Latest();
+    if (frame->sequence != drawn) {
+      drawn = frame->sequence;
+      // A process controlling the game through BRICKGAME_SHM can quit it.
+      if (frame->state == Terminate) break;
+      if (frame->state != Pause && frame->state != GAMEOVER) {
+        game_field_text(frame);
+        draw_game_field(main_win, frame);
+        draw_next_figure(next_figure_win, frame);
+      } else if (frame->state == Pause) {
+        game_field_text(frame);
+        clear_win(main_win);
+        pause_text();
+      } else if (frame->state == GAMEOVER) {
+        clear_win(main_win);
+        gameover_text();
+      }
     }
+
+    wait_for_input(-1, wake[0]);
+  }
+  game_thread.Stop();
+  shared_session_destroy(shared, shared_name);
+  close_wake_pipe(wake);
+  if (replay_path) {
+    finish_recording(game);
+    replay_save(&replay, replay_path);
+    replay_free(&replay);
   }
   free_game_init(game);
-}
\ No newline at end of file
+  return true;
+}
@@ -0,0 +1,106 @@
+#include "inc/field_canvas.h"
+
+namespace s21 {
+
+FieldCanvas::FieldCanvas()
+    : width_(kNextX + FIGURE_SIZE * kCellPitch + kMargin),
+      height_(kMargin * 2 + FIELD_HEIGHT * kCellPitch) {
+  for (auto &row : field_values_) row.fill(0);
+  for (auto &row : next_values_) row.fill(0);
+  set_content_width(width_);
+  set_content_height(height_);
+  set_draw_func(sigc::mem_fun(*this, &FieldCanvas::on_draw));
+}
+
+void FieldCanvas::set_palette(const std::vector<std::string> &colors) {
+  palette_.clear();
+  for (const auto &color : colors) {
+    unsigned long rgb = std::stoul(color.substr(1), nullptr, 16);
+    palette_.push_back({((rgb >> 16) & 0xFF) / 255.0,
+                        ((rgb >> 8) & 0xFF) / 255.0, (rgb & 0xFF) / 255.0});
+  }
+  background_.reset();
+  frame_.reset();
+  frame_cr_.reset();
+  queue_draw();
+}
+
+void FieldCanvas::set_cell(int row, int col, int cell_value) {
+  if (field_values_[row][col] == cell_value) return;
+  field_values_[row][col] = cell_value;
+  if (frame_) {
+    paint_cell(kMargin + col * kCellPitch, kMargin + row * kCellPitch,
+               cell_value);
+  }
+  queue_draw();
+}
+
+void FieldCanvas::set_next_cell(int row, int col, int cell_value) {
+  if (next_values_[row][col] == cell_value) return;
+  next_values_[row][col] = cell_value;
+  if (frame_) {
+    paint_cell(kNextX + col * kCellPitch, kMargin + row * kCellPitch,
+               cell_value);
+  }
+  queue_draw();
+}
+
+void FieldCanvas::on_draw(const Cairo::RefPtr<Cairo::Context> &cr, int width,
+                          int height) {
+  (void)width;
+  (void)height;
+  ensure_surfaces();
+  cr->set_source(frame_, 0, 0);
+  cr->paint();
+}
+
+void FieldCanvas::ensure_surfaces() {
+  if (!background_) {
+    background_ = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32,
+                                              width_, height_);
+    draw_background(Cairo::Context::create(background_));
+  }
+  if (!frame_) {
+    frame_ = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32,
+                                         width_, height_);
+    frame_cr_ = Cairo::Context::create(frame_);
+    frame_cr_->set_source(background_, 0, 0);
+    frame_cr_->paint();
+    for (int row = 0; row < FIELD_HEIGHT; ++row) {
+      for (int col = 0; col < FIELD_WIDTH; ++col) {
+        paint_cell(kMargin + col * kCellPitch, kMargin + row * kCellPitch,
+                   field_values_[row][col]);
+      }
+    }
+    for (int row = 0; row < FIGURE_SIZE; ++row) {
+      for (int col = 0; col < FIGURE_SIZE; ++col) {
+        paint_cell(kNextX + col * kCellPitch, kMargin + row * kCellPitch,
+                   next_values_[row][col]);
+      }
+    }
+  }
+}
+
+void FieldCanvas::draw_background(const Cairo::RefPtr<Cairo::Context> &cr) {
+  cr->set_source_rgb(0.85, 0.85, 0.85);
+  cr->rectangle(kMargin - 1, kMargin - 1, FIELD_WIDTH * kCellPitch + 1,
+                FIELD_HEIGHT * kCellPitch + 1);
+  cr->rectangle(kNextX - 1, kMargin - 1, FIGURE_SIZE * kCellPitch + 1,
+                FIGURE_SIZE * kCellPitch + 1);
+  cr->fill();
+}
+
+void FieldCanvas::paint_cell(int x, int y, int cell_value) {
+  Rgb color = {1.0, 1.0, 1.0};
+  if (cell_value > 0 && cell_value < static_cast<int>(palette_.size())) {
+    color = palette_[cell_value];
+  }
+  frame_cr_->set_source_rgb(1.0, 1.0, 1.0);
+  frame_cr_->rectangle(x, y, kCellSize, kCellSize);
+  frame_cr_->fill();
+  frame_cr_->set_source_rgb(color.r, color.g, color.b);
+  frame_cr_->rectangle(x + 1, y + 1, kCellSize - 2, kCellSize - 2);
+  frame_cr_->fill();
+}
+
+}  // namespace s21
@@ -1,9 +1,18 @@
 #include "inc/game_view.h"
 
+#include <iostream>
+
 namespace s21 {
 
-GameWindow::GameWindow()
-    : button_start_snake_("S N A K E"), button_start_tetris_("T E T R I S") {
+GameWindow::GameWindow(Renderer renderer, bool frame_stats,
+                       const std::string &replay_path,
+                       const std::string &shared_name)
+    : button_start_snake_("S N A K E"),
+      button_start_tetris_("T E T R I S"),
+      renderer_(renderer),
+      frame_stats_(frame_stats),
+      replay_path_(replay_path),
+      shared_name_(shared_name) {
   set_title("BrickGame");
   set_default_size(500, 400);
 
@@ -70,16 +79,89 @@ void GameWindow::show_game_ui() {
     game_model_ = std::make_unique<GameModel>();
     game_controller_ = std::make_unique<GameController>(game_model_.get());
   }
+  start_game_thread();
 
   set_child(overlay_);
 }
 
+void GameWindow::start_game_thread() {
+  if (game_ == Game::snake) {
+    game_thread_ = std::make_unique<GameThread>(
+        [this](const InputEvent &event) {
+          game_controller_->userInput(event.action, event.hold);
+        },
+        [this](long long now_us) {
+          (void)now_us;
+          game_model_->Advance();
+          int left_ms = game_model_->GetTimeToUpdate();
+          return left_ms < 0 ? -1LL : left_ms * 1000LL;
+        },
+        [this](Frame *frame) { game_model_->Snapshot(frame); });
+  } else {
+    game_thread_ = std::make_unique<GameThread>(
+        [this](const InputEvent &event) {
+          apply_user_action(tetris_game_info_, event.action);
+        },
+        [this](long long now_us) {
+          if (tetris_game_info_->status == GAMEOVER ||
+              tetris_game_info_->status == RESET) {
+            reset_game(tetris_game_info_);
+            init_game_clock(tetris_game_info_, &tetris_clock_);
+          }
+          advance_game(tetris_game_info_, &tetris_clock_, now_us);
+          return time_to_gravity_us(tetris_game_info_, &tetris_clock_, now_us);
+        },
+        [this](Frame *frame) { snapshot_game(tetris_game_info_, frame); });
+  }
+
+  if (!replay_path_.empty()) {
+    if (game_ == Game::snake) {
+      replay_init(&replay_, REPLAY_SNAKE, 0, game_model_->GetSeed());
+      game_model_->SetRecorder(&replay_);
+    } else {
+      record_game(tetris_game_info_, &replay_);
+    }
+  }
+  if (!shared_name_.empty()) {
+    shared_ = shared_session_create(
+        shared_name_.c_str(),
+        game_ == Game::snake ? SHARED_SNAKE : SHARED_TETRIS);
+    if (shared_ == nullptr) {
+      std::cerr << "cannot share the game as " << shared_name_ << std::endl;
+    }
+    game_thread_->Share(shared_);
+  }
+  game_thread_->Start();
+}
+
+void GameWindow::save_replay() {
+  if (replay_path_.empty()) return;
+  if (game_ == Game::snake) {
+    replay_.final_hash = game_model_->StateHash();
+    game_model_->SetRecorder(nullptr);
+  } else {
+    finish_recording(tetris_game_info_);
+  }
+  if (!replay_save(&replay_, replay_path_.c_str())) {
+    std::cerr << "cannot write replay " << replay_path_ << std::endl;
+  }
+  replay_free(&replay_);
+}
+
+void GameWindow::release_shared() {
+  shared_session_destroy(shared_, shared_name_.c_str());
+  shared_ = nullptr;
+}
+
 void GameWindow::initialize_game_ui() {
+  initialize_cell_palette();
   initialize_labels();
   initialize_grids();
 
-  initialize_game_field_grid();
-  initialize_next_figure_grid();
+  if (renderer_ == Renderer::widgets) {
+    initialize_game_field_grid();
+    initialize_next_figure_grid();
+  }
 
   initialize_containers();
 }
@@ -115,28 +197,56 @@ std::string GameWindow::get_cell_color(int cell_value) {
   return color;
 }
 
-void GameWindow::set_cell_color(int row, int col, const std::string &color) {
-  auto css_provider = Gtk::CssProvider::create();
-  std::string css =
-      "box { background-color: " + color + "; border: 1px solid #FFFFFF; }";
-  css_provider->load_from_data(css);
-  game_field_cells_[row][col]->get_style_context()->add_provider(
-      css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
+std::string GameWindow::get_cell_class(int cell_value) {
+  if (cell_value < 0 || cell_value > CYAN_COLOR) cell_value = 0;
+  return "cell-" + std::to_string(cell_value);
 }
 
-void GameWindow::set_next_figure_cell_color(int row, int col,
-                                            const std::string &color) {
-  auto css_provider = Gtk::CssProvider::create();
-  std::string css =
-      "box { background-color: " + color + "; border: 1px solid #FFFFFF; }";
-  css_provider->load_from_data(css);
-  next_figure_cells_[row][col]->get_style_context()->add_provider(
-      css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
+void GameWindow::initialize_cell_palette() {
+  std::string css;
+  for (int value = 0; value <= CYAN_COLOR; ++value) {
+    css += "box." + get_cell_class(value) +
+           " { background-color: " + get_cell_color(value) +
+           "; border: 1px solid #FFFFFF; }\n";
+  }
+  cell_css_provider_ = Gtk::CssProvider::create();
+  cell_css_provider_->load_from_data(css);
+
+  std::vector<std::string> colors;
+  for (int value = 0; value <= CYAN_COLOR; ++value) {
+    colors.push_back(get_cell_color(value));
+  }
+  field_canvas_.set_palette(colors);
+}
+
+void GameWindow::set_cell_color(int row, int col, int cell_value) {
+  if (renderer_ == Renderer::canvas) {
+    field_canvas_.set_cell(row, col, cell_value);
+    return;
+  }
+  int &current = game_field_values_[row][col];
+  if (current == cell_value) return;
+  game_field_cells_[row][col]->remove_css_class(get_cell_class(current));
+  game_field_cells_[row][col]->add_css_class(get_cell_class(cell_value));
+  current = cell_value;
+}
+
+void GameWindow::set_next_figure_cell_color(int row, int col, int cell_value) {
+  if (renderer_ == Renderer::canvas) {
+    field_canvas_.set_next_cell(row, col, cell_value);
+    return;
+  }
+  int &current = next_figure_values_[row][col];
+  if (current == cell_value) return;
+  next_figure_cells_[row][col]->remove_css_class(get_cell_class(current));
+  next_figure_cells_[row][col]->add_css_class(get_cell_class(cell_value));
+  current = cell_value;
 }
 
 void GameWindow::initialize_game_field_grid() {
   game_field_cells_.resize(FIELD_HEIGHT,
                            std::vector<Gtk::Widget *>(FIELD_WIDTH, nullptr));
+  game_field_values_.assign(FIELD_HEIGHT, std::vector<int>(FIELD_WIDTH, 0));
 
   for (int row = 0; row < FIELD_HEIGHT; ++row) {
     for (int col = 0; col < FIELD_WIDTH; ++col) {
@@ -145,11 +255,9 @@ void GameWindow::initialize_game_field_grid() {
 
       game_field_cells_[row][col] = cell;
 
-      auto cell_css_provider = Gtk::CssProvider::create();
-      cell_css_provider->load_from_data(
-          "box { background-color: #FFFFFF; border: 1px solid #FFFFFF; }");
-      cell->get_style_context()->add_provider(cell_css_provider,
+      cell->get_style_context()->add_provider(cell_css_provider_,
                                               GTK_STYLE_PROVIDER_PRIORITY_USER);
+      cell->add_css_class(get_cell_class(0));
 
       game_field_grid_.attach(*cell, col, row, 1, 1);
     }
@@ -159,6 +267,7 @@ void GameWindow::initialize_game_field_grid() {
 void GameWindow::initialize_next_figure_grid() {
   next_figure_cells_.resize(FIGURE_SIZE,
                             std::vector<Gtk::Widget *>(FIGURE_SIZE, nullptr));
+  next_figure_values_.assign(FIGURE_SIZE, std::vector<int>(FIGURE_SIZE, 0));
 
   for (int row = 0; row < FIGURE_SIZE; ++row) {
     for (int col = 0; col < FIGURE_SIZE; ++col) {
@@ -167,11 +276,9 @@ void GameWindow::initialize_next_figure_grid() {
 
       next_figure_cells_[row][col] = cell;
 
-      auto cell_css_provider = Gtk::CssProvider::create();
-      cell_css_provider->load_from_data(
-          "box { background-color: #FFFFFF; border: 1px solid #FFFFFF; }");
-      cell->get_style_context()->add_provider(cell_css_provider,
+      cell->get_style_context()->add_provider(cell_css_provider_,
                                               GTK_STYLE_PROVIDER_PRIORITY_USER);
+      cell->add_css_class(get_cell_class(0));
 
       next_figure_grid_.attach(*cell, col, row, 1, 1);
     }
@@ -275,10 +382,14 @@ void GameWindow::initialize_containers() {
   main_box_.append(game_name_label_);
   main_box_.append(game_info_box_);
 
-  info_box_.append(next_figure_grid_);
-  info_box_.append(info_grid_);
-
-  game_info_box_.append(game_field_grid_);
+  if (renderer_ == Renderer::canvas) {
+    info_box_.append(info_grid_);
+    game_info_box_.append(field_canvas_);
+  } else {
+    info_box_.append(next_figure_grid_);
+    info_box_.append(info_grid_);
+    game_info_box_.append(game_field_grid_);
+  }
   game_info_box_.append(info_box_);
 }
 
@@ -373,4 +484,22 @@ void GameWindow::set_controller() {
   }
 }
 
+void GameWindow::record_frame_time(
+    std::chrono::steady_clock::time_point start) {
+  if (!frame_stats_) return;
+  frame_time_us_ += std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  if (++frame_count_ == 100) {
+    std::cerr << (renderer_ == Renderer::canvas ? "canvas" : "widgets")
+              << " renderer: " << frame_time_us_ / frame_count_
+              << " us per frame update";
+    auto frame_clock = get_frame_clock();
+    if (frame_clock) std::cerr << ", " << frame_clock->get_fps() << " fps";
+    std::cerr << std::endl;
+    frame_count_ = 0;
+    frame_time_us_ = 0;
+  }
+}
+
 } // namespace s21
\ No newline at end of file
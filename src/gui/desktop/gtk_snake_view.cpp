@@ -3,33 +3,36 @@
 namespace s21{
 bool GameWindow::key_handling_snake(guint keyval, guint keycode,
                               Gdk::ModifierType state) {
+  if (!game_thread_) {
+    return false;
+  }
   switch (keyval) {
   case GDK_KEY_Left:
-    game_controller_->userInput(Left, false);
+    game_thread_->Post(Left, false);
     break;
   case GDK_KEY_Right:
-    game_controller_->userInput(Right, false);
+    game_thread_->Post(Right, false);
     break;
   case GDK_KEY_Up:
-    game_controller_->userInput(Up, false);
+    game_thread_->Post(Up, false);
     break;
   case GDK_KEY_Down:
-    game_controller_->userInput(Down, false);
+    game_thread_->Post(Down, false);
     break;
   case GDK_KEY_x:
   case GDK_KEY_X:
-    game_controller_->userInput(Action, true);
+    game_thread_->Post(Action, true);
     break;
   case GDK_KEY_p:
   case GDK_KEY_P:
-    game_controller_->userInput(Pause, false);
+    game_thread_->Post(Pause, false);
     break;
   case GDK_KEY_q:
   case GDK_KEY_Q:
-    game_controller_->userInput(Terminate, false);
+    game_thread_->Post(Terminate, false);
     break;
   case GDK_KEY_Return:
-    game_controller_->userInput(Start, false);
+    game_thread_->Post(Start, false);
     break;
   default:
     break;
@@ -39,26 +42,34 @@ bool GameWindow::key_handling_snake(guint keyval, guint keycode,
 
 bool GameWindow::key_release_handling_snake(guint keyval, guint keycode,
                                             Gdk::ModifierType state) {
-  if (keyval == GDK_KEY_x || keyval == GDK_KEY_X) {
-    game_controller_->userInput(Action, false);
+  if (game_thread_ && (keyval == GDK_KEY_x || keyval == GDK_KEY_X)) {
+    game_thread_->Post(Action, false);
     return true;
   }
   return false;
 }
 
 bool GameWindow::on_timeout_snake() {
-  game_info_ = game_model_->UpdateCurrentState();
-  GameState state = game_model_->GetGameState();
+  auto frame_start = std::chrono::steady_clock::now();
+  const Frame *frame = game_thread_->Latest();
+  if (frame->sequence == drawn_frame_) {
+    return true;
+  }
+  drawn_frame_ = frame->sequence;
+  GameState state = static_cast<GameState>(frame->state);
 
   if (state == Exit) {
+    game_thread_.reset();
+    release_shared();
+    save_replay();
     hide();
     return false;
   }
 
   if (state != Paused && state != GameOver && state != Win) {
-    level_ = game_info_.level;
-    score_ = game_info_.score;
-    max_score_ = game_info_.high_score;
+    level_ = frame->level;
+    score_ = frame->score;
+    max_score_ = frame->high_score;
 
     score_label_.set_text("LEVEL: " + std::to_string(level_));
     level_label_.set_text("SCORE: " + std::to_string(score_));
@@ -66,9 +77,7 @@ bool GameWindow::on_timeout_snake() {
 
     for (int row = 0; row < FIELD_HEIGHT; ++row) {
       for (int col = 0; col < FIELD_WIDTH; ++col) {
-        int cell_value = game_info_.field[row][col];
-        std::string color = get_cell_color(cell_value);
-        set_cell_color(row, col, color);
+        set_cell_color(row, col, frame->field[row][col]);
       }
     }
   }
@@ -91,6 +100,7 @@ bool GameWindow::on_timeout_snake() {
     win_label_.set_visible(false);
   }
 
+  record_frame_time(frame_start);
   return true;
 }
 }
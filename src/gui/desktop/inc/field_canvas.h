@@ -0,0 +1,126 @@
+/**
+ * @file field_canvas.h
+ * @brief Заголовочный файл для отрисовки игрового поля и превью следующей
+ * фигуры средствами Cairo в одном Gtk::DrawingArea.
+ */
+
+#ifndef FIELD_CANVAS_H
+#define FIELD_CANVAS_H
+
+#include <gtkmm.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../../../brick_game/inc/defines.h"
+
+namespace s21 {
+
+/**
+ * @class FieldCanvas
+ * @brief Виджет, рисующий обе сетки игры без отдельного виджета на ячейку.
+ *
+ * Статический фон с рамками сеток рисуется один раз и кэшируется. Изменённые
+ * ячейки дорисовываются в закадровую поверхность, а обработчик отрисовки
+ * только копирует её на экран.
+ */
+class FieldCanvas : public Gtk::DrawingArea {
+ public:
+  /**
+   * @brief Конструктор объекта FieldCanvas.
+   */
+  FieldCanvas();
+
+  /**
+   * @brief Задаёт цвета значений ячеек.
+   *
+   * @param colors Цвета в формате "#RRGGBB", индекс совпадает со значением
+   * ячейки.
+   */
+  void set_palette(const std::vector<std::string> &colors);
+
+  /**
+   * @brief Устанавливает значение ячейки игрового поля.
+   *
+   * @param row Индекс строки.
+   * @param col Индекс столбца.
+   * @param cell_value Значение ячейки.
+   */
+  void set_cell(int row, int col, int cell_value);
+
+  /**
+   * @brief Устанавливает значение ячейки превью следующей фигуры.
+   *
+   * @param row Индекс строки.
+   * @param col Индекс столбца.
+   * @param cell_value Значение ячейки.
+   */
+  void set_next_cell(int row, int col, int cell_value);
+
+ private:
+  static constexpr int kCellSize = 20;   /**< Размер ячейки в пикселях */
+  static constexpr int kCellPitch = 21;  /**< Шаг сетки с учётом зазора */
+  static constexpr int kMargin = 10;     /**< Отступ вокруг сеток */
+  static constexpr int kNextX =
+      kMargin * 3 + FIELD_WIDTH * kCellPitch; /**< Левый край превью */
+
+  /**
+   * @struct Rgb
+   * @brief Цвет ячейки в компонентах Cairo.
+   */
+  struct Rgb {
+    double r;
+    double g;
+    double b;
+  };
+
+  /**
+   * @brief Обработчик отрисовки, копирующий закадровую поверхность.
+   *
+   * @param cr Контекст Cairo.
+   * @param width Ширина области.
+   * @param height Высота области.
+   */
+  void on_draw(const Cairo::RefPtr<Cairo::Context> &cr, int width,
+               int height);
+
+  /**
+   * @brief Создаёт кэш фона и закадровую поверхность.
+   */
+  void ensure_surfaces();
+
+  /**
+   * @brief Рисует статический фон обеих сеток.
+   *
+   * @param cr Контекст Cairo.
+   */
+  void draw_background(const Cairo::RefPtr<Cairo::Context> &cr);
+
+  /**
+   * @brief Рисует одну ячейку в закадровую поверхность.
+   *
+   * @param x Левый край ячейки.
+   * @param y Верхний край ячейки.
+   * @param cell_value Значение ячейки.
+   */
+  void paint_cell(int x, int y, int cell_value);
+
+  int width_;  /**< Ширина области в пикселях */
+  int height_; /**< Высота области в пикселях */
+
+  std::vector<Rgb> palette_; /**< Цвета значений ячеек */
+  std::array<std::array<int, FIELD_WIDTH>, FIELD_HEIGHT>
+      field_values_; /**< Отрисованные значения ячеек поля */
+  std::array<std::array<int, FIGURE_SIZE>, FIGURE_SIZE>
+      next_values_; /**< Отрисованные значения ячеек превью */
+
+  Cairo::RefPtr<Cairo::ImageSurface> background_; /**< Кэш статического фона */
+  Cairo::RefPtr<Cairo::ImageSurface> frame_; /**< Закадровая поверхность */
+  Cairo::RefPtr<Cairo::Context> frame_cr_;   /**< Контекст закадровой
+                                                поверхности */
+};
+
+}  // namespace s21
+
+#endif
@@ -8,11 +8,16 @@
 
 #include <gtkmm.h>
 
+#include <chrono>
+#include <string>
+
+#include "../../../brick_game/common/inc/game_thread.h"
 #include "../../../brick_game/inc/defines.h"
 #include "../../../brick_game/snake/controller/inc/game_controller.h"
 #include "../../../brick_game/snake/model/inc/game_model.h"
 #include "../../../brick_game/tetris/inc/backend.h"
 #include "../../../brick_game/tetris/inc/fsm_t.h"
+#include "field_canvas.h"
 
 namespace s21 {
 
@@ -22,6 +27,15 @@ namespace s21 {
  */
 typedef enum { snake, tetris } Game;
 
+/**
+ * @enum Renderer
+ * @brief Перечисляет способы отрисовки игровых сеток.
+ */
+enum class Renderer {
+  widgets, /**< Сетка из виджетов Gtk::Box, стилизуемых через CSS */
+  canvas   /**< Одна область Gtk::DrawingArea, рисуемая через Cairo */
+};
+
 /**
  * @class GameWindow
  * @brief Представляет главное игровое окно, обрабатывающее UI и взаимодействия.
@@ -33,8 +47,18 @@ class GameWindow : public Gtk::Window {
  public:
   /**
    * @brief Конструктор объекта GameWindow.
+   *
+   * @param renderer Способ отрисовки игровых сеток.
+   * @param frame_stats Флаг вывода среднего времени кадра в stderr.
+   * @param replay_path Файл, в который записывается реплей игры; пустая
+   * строка отключает запись.
+   * @param shared_name Имя объекта общей памяти, через который игрой
+   * управляют другие процессы; пустая строка отключает доступ.
    */
-  GameWindow();
+  explicit GameWindow(Renderer renderer = Renderer::widgets,
+                      bool frame_stats = false,
+                      const std::string &replay_path = "",
+                      const std::string &shared_name = "");
 
   /**
    * @brief Деструктор объекта GameWindow и отключает сигналы.
@@ -46,6 +70,8 @@ class GameWindow : public Gtk::Window {
     timeout_connection_.disconnect();
     connection_key_pressed_.disconnect();
     connection_key_released_.disconnect();
+    game_thread_.reset();
+    release_shared();
   };
 
   /**
@@ -94,23 +120,42 @@ class GameWindow : public Gtk::Window {
    */
   std::string get_cell_color(int cell_value);
 
+  /**
+   * @brief Получает имя CSS-класса, связанного со значением ячейки.
+   *
+   * @param cell_value Значение ячейки.
+   * @return Имя CSS-класса.
+   */
+  std::string get_cell_class(int cell_value);
+
+  /**
+   * @brief Создаёт CSS-палитру с отдельным классом для каждого цвета ячейки.
+   */
+  void initialize_cell_palette();
+
   /**
    * @brief Устанавливает цвет конкретной ячейки на игровом поле.
    *
+   * Меняет только CSS-класс ячейки и ничего не делает, если значение не
+   * изменилось.
+   *
    * @param row Индекс строки.
    * @param col Индекс столбца.
-   * @param color Цвет для установки.
+   * @param cell_value Значение ячейки.
    */
-  void set_cell_color(int row, int col, const std::string &color);
+  void set_cell_color(int row, int col, int cell_value);
 
   /**
    * @brief Устанавливает цвет конкретной ячейки в превью следующей фигуры.
    *
+   * Меняет только CSS-класс ячейки и ничего не делает, если значение не
+   * изменилось.
+   *
    * @param row Индекс строки.
    * @param col Индекс столбца.
-   * @param color Цвет для установки.
+   * @param cell_value Значение ячейки.
    */
-  void set_next_figure_cell_color(int row, int col, const std::string &color);
+  void set_next_figure_cell_color(int row, int col, int cell_value);
 
   /**
    * @brief Инициализирует компоненты интерфейса главного меню.
@@ -172,6 +217,13 @@ class GameWindow : public Gtk::Window {
    */
   void set_controller();
 
+  /**
+   * @brief Учитывает время обработки кадра и периодически выводит среднее.
+   *
+   * @param start Момент начала обработки кадра.
+   */
+  void record_frame_time(std::chrono::steady_clock::time_point start);
+
  private:
   Gtk::Box menu_box_{Gtk::Orientation::VERTICAL,
                      10};                       /**< Контейнер Box для меню */
@@ -192,6 +244,7 @@ class GameWindow : public Gtk::Window {
   Gtk::Grid game_field_grid_;  /**< Сетка для игрового поля */
   Gtk::Grid next_figure_grid_; /**< Сетка для превью следующей фигуры */
   Gtk::Grid info_grid_;        /**< Сетка для отображения информации об игре */
+  FieldCanvas field_canvas_;   /**< Область отрисовки сеток через Cairo */
 
   Gtk::Label game_name_label_;     /**< Метка отображающая название игры */
   Gtk::Label pause_message_label_; /**< Метка отображающая сообщения о паузе */
@@ -217,6 +270,12 @@ class GameWindow : public Gtk::Window {
       game_field_cells_; /**< 2D вектор ячеек игрового поля */
   std::vector<std::vector<Gtk::Widget *>>
       next_figure_cells_; /**< 2D вектор ячеек для превью следующей фигуры */
+  std::vector<std::vector<int>>
+      game_field_values_; /**< Значения, отображаемые ячейками поля */
+  std::vector<std::vector<int>>
+      next_figure_values_; /**< Значения, отображаемые ячейками превью */
+  Glib::RefPtr<Gtk::CssProvider>
+      cell_css_provider_; /**< CSS-палитра цветов ячеек */
 
   sigc::connection
       connection_start_snake_; /**< Соединение сигнала для запуска Snake */
@@ -233,13 +292,46 @@ class GameWindow : public Gtk::Window {
   int max_score_; /**< Максимально достигнутый счёт */
 
   Game game_;            /**< Текущая игра */
-  GameInfo_t game_info_; /**< Структура, содержащая информацию об игре */
+  unsigned long long drawn_frame_ =
+      0; /**< Номер последнего отрисованного кадра */
   std::unique_ptr<GameModel> game_model_; /**< Указатель на модель игры */
   std::unique_ptr<GameController>
       game_controller_; /**< Указатель на контроллер игры */
 
   GameInfo_t *tetris_game_info_ =
       nullptr; /**< Указатель на информацию о игре Tetris */
+  GameClock tetris_clock_{}; /**< Часы с фиксированным шагом игры Tetris */
+  std::unique_ptr<GameThread>
+      game_thread_; /**< Поток, в котором идёт текущая игра */
+
+  Renderer renderer_;        /**< Способ отрисовки игровых сеток */
+  bool frame_stats_;         /**< Флаг вывода статистики времени кадра */
+  int frame_count_ = 0;      /**< Число кадров в текущем окне статистики */
+  double frame_time_us_ = 0; /**< Суммарное время кадров окна, мкс */
+  std::string replay_path_;  /**< Файл реплея или пустая строка */
+  Replay replay_{};          /**< Записываемый реплей текущей игры */
+  std::string shared_name_;  /**< Имя общей памяти или пустая строка */
+  SharedSession *shared_ = nullptr; /**< Сессия общей памяти текущей игры */
+
+  /**
+   * @brief Запускает поток текущей игры.
+   *
+   * Клавиши только ставят действия в очередь потока, а таймаут окна лишь
+   * отрисовывает состояние, поэтому медленный кадр не задерживает игру.
+   */
+  void start_game_thread();
+
+  /**
+   * @brief Дописывает хеш конечного состояния и сохраняет реплей, если
+   * запись включена. Вызывается после остановки потока игры.
+   */
+  void save_replay();
+
+  /**
+   * @brief Удаляет сессию общей памяти текущей игры. Вызывается после
+   * остановки потока игры.
+   */
+  void release_shared();
 
   /**
    * @brief Инициализирует настройки, специфичные для игры Tetris.
@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <cstring>
+
 #include "./gui/desktop/inc/game_view.h"
 
 /**
@@ -5,6 +8,10 @@
  *
  * This function initializes the game window, sets up the colors
  * starts the game loop, and cleans up the window before exiting.
+ * Setting BRICKGAME_RENDERER=canvas draws the grids with Cairo instead of
+ * per-cell widgets, and setting BRICKGAME_FRAME_STATS prints the average
+ * frame update time to stderr. Setting BRICKGAME_SHM=/name shares the game
+ * with other processes through that shared-memory object.
  *
  * @return 0 indicating successful execution of the program.
  */
@@ -12,8 +19,21 @@
 int main(int argc, char *argv[]) {
   auto app = Gtk::Application::create("com.example.BrickGame");
 
-  app->signal_activate().connect([&app]() {
-    auto window = new s21::GameWindow();
+  const char *renderer_env = std::getenv("BRICKGAME_RENDERER");
+  s21::Renderer renderer =
+      renderer_env && std::strcmp(renderer_env, "canvas") == 0
+          ? s21::Renderer::canvas
+          : s21::Renderer::widgets;
+  bool frame_stats = std::getenv("BRICKGAME_FRAME_STATS") != nullptr;
+  const char *replay_env = std::getenv("BRICKGAME_REPLAY");
+  std::string replay_path = replay_env ? replay_env : "";
+  const char *shared_env = std::getenv("BRICKGAME_SHM");
+  std::string shared_name = shared_env ? shared_env : "";
+
+  app->signal_activate().connect([&app, renderer, frame_stats, replay_path,
+                                  shared_name]() {
+    auto window =
+        new s21::GameWindow(renderer, frame_stats, replay_path, shared_name);
     window->set_application(app);
     window->present();
   });
@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "./gui/cli/inc/frontend.h"
 
 /**
@@ -6,21 +9,26 @@
  * This function initializes the game window, sets up the colors
  * starts the game loop, and cleans up the window before exiting.
  *
- * @return 0 indicating successful execution of the program.
+ * @return 0 on success, 1 if the game could not be shared as BRICKGAME_SHM
+ * asks.
  */
 
 int main() {
   win_init();
   color_init();
-  srand(time(NULL));
 
   int choice = show_menu();
+  bool shared = true;
   if (choice == 1) {
-    game_loop_tetris();
+    shared = game_loop_tetris();
   } else if (choice == 2) {
-    game_loop_snake();
+    shared = game_loop_snake();
   }
 
   endwin();
+  if (!shared) {
+    fprintf(stderr, "cannot share the game as %s\n", getenv("BRICKGAME_SHM"));
+    return 1;
+  }
   return 0;
 }
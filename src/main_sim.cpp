@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "./sim/inc/simulation.h"
+
+/**
+ * @brief Prints command line usage of the simulation driver.
+ * @param name Name of the executable.
+ */
+static void print_usage(const char *name) {
+  std::cerr << "usage: " << name
+            << " [--game tetris|snake] [--games N] [--seed S]"
+               " [--pieces uniform|bag|tgm] [--threads N] [--max-ticks T]"
+               " [--script FILE] [--bot DEPTH] [--replay FILE [--seek STEP]]\n";
+}
+
+/**
+ * @brief Main function of the headless simulation driver.
+ *
+ * This function plays the requested number of games with scripted or random
+ * input at full speed and prints throughput and score statistics, or
+ * re-simulates a recorded replay and checks its final state, or jumps to a
+ * step of a replay and prints the state there.
+ *
+ * @return 0 on success, 1 on invalid arguments or a diverged replay.
+ */
+
+int main(int argc, char *argv[]) {
+  s21::SimOptions options;
+  const char *replay_path = nullptr;
+  const char *seek_step = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    if (std::strcmp(arg, "--game") == 0 && std::strcmp(value, "tetris") == 0) {
+      options.game = s21::SimGame::tetris;
+    } else if (std::strcmp(arg, "--game") == 0 &&
+               std::strcmp(value, "snake") == 0) {
+      options.game = s21::SimGame::snake;
+    } else if (std::strcmp(arg, "--games") == 0) {
+      options.games = std::atoi(value);
+    } else if (std::strcmp(arg, "--seed") == 0) {
+      options.seed = std::strtoul(value, nullptr, 10);
+    } else if (std::strcmp(arg, "--pieces") == 0) {
+      if (!piece_mode_from_name(value, &options.pieces)) {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (std::strcmp(arg, "--threads") == 0) {
+      options.threads = std::atoi(value);
+    } else if (std::strcmp(arg, "--max-ticks") == 0) {
+      options.max_ticks = std::atol(value);
+    } else if (std::strcmp(arg, "--bot") == 0) {
+      options.bot = std::atoi(value);
+    } else if (std::strcmp(arg, "--replay") == 0) {
+      replay_path = value;
+    } else if (std::strcmp(arg, "--seek") == 0) {
+      seek_step = value;
+    } else if (std::strcmp(arg, "--script") == 0) {
+      if (!s21::LoadScript(value, &options.script)) {
+        std::cerr << "cannot read script " << value << '\n';
+        return 1;
+      }
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+    ++i;
+  }
+
+  if (replay_path != nullptr && seek_step != nullptr) {
+    return s21::RunSeek(replay_path, std::strtoul(seek_step, nullptr, 10),
+                        std::cout)
+               ? 0
+               : 1;
+  }
+  if (replay_path != nullptr) {
+    return s21::RunReplay(replay_path, std::cout) ? 0 : 1;
+  }
+
+  if (options.games <= 0 || options.max_ticks <= 0 || options.threads < 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  s21::SimReport report = s21::RunSimulation(options);
+  if (report.failed > 0) {
+    std::cerr << "out of memory, " << report.failed << " games not played\n";
+    return 1;
+  }
+  s21::PrintReport(options, report, std::cout);
+  return 0;
+}
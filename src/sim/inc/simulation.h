@@ -0,0 +1,160 @@
+/**
+ * @file simulation.h
+ * @brief Header file containing the headless batch simulation driver for both
+ * games.
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../brick_game/inc/defines.h"
+#include "../../brick_game/tetris/inc/piece_generator.h"
+
+namespace s21 {
+
+/**
+ * @enum SimGame
+ * @brief Game driven by the simulation.
+ */
+enum class SimGame { tetris, snake };
+
+/**
+ * @struct SimOptions
+ * @brief Parameters of a simulation run.
+ * @var SimOptions.game Game to simulate.
+ * @var SimOptions.games Number of games to play.
+ * @var SimOptions.seed Seed of the piece and input generators.
+ * @var SimOptions.pieces Tetris piece randomizer.
+ * @var SimOptions.threads Number of worker threads, 0 for one per hardware
+ * thread.
+ * @var SimOptions.max_ticks Tick limit of a single game.
+ * @var SimOptions.script Scripted input, one action per tick, repeated in a
+ * loop. Random input is used when empty.
+ * @var SimOptions.bot Search depth of the tetris bot playing instead of the
+ * script or random input, 0 to leave it off. Any other value lets the snake
+ * autopilot play.
+ */
+struct SimOptions {
+  SimGame game = SimGame::tetris;
+  int games = 100;
+  unsigned seed = 1;
+  PieceMode pieces = PIECES_BAG;
+  int threads = 1;
+  long max_ticks = 1000000;
+  std::vector<UserAction_t> script;
+  int bot = 0;
+};
+
+/**
+ * @struct SimResult
+ * @brief Outcome of a single simulated game.
+ * @var SimResult.score Final score.
+ * @var SimResult.ticks Number of engine ticks the game lasted.
+ */
+struct SimResult {
+  int score;
+  long ticks;
+};
+
+/**
+ * @struct SimReport
+ * @brief Outcome of a whole simulation run.
+ * @var SimReport.results Results of every game, indexed by game number.
+ * @var SimReport.seconds Wall time spent simulating.
+ * @var SimReport.threads Number of worker threads used.
+ * @var SimReport.failed Number of games not played because memory ran out;
+ * their results are zero.
+ */
+struct SimReport {
+  std::vector<SimResult> results;
+  double seconds;
+  int threads;
+  int failed;
+};
+
+/**
+ * @brief Returns the seed of one game of a run, so every game is
+ * reproducible on its own whichever thread plays it.
+ * @param options Simulation parameters.
+ * @param index Number of the game in the run.
+ * @return Seed of the game.
+ */
+uint64_t GameSeed(const SimOptions &options, int index);
+
+/**
+ * @brief Plays one tetris game through calculate_game() until game over.
+ * @param options Simulation parameters.
+ * @param seed Seed of the game input and pieces.
+ * @param game Game reused between runs on the same thread; it is reset and
+ * reseeded before playing.
+ * @return Result of the game.
+ */
+SimResult RunTetrisGame(const SimOptions &options, uint64_t seed,
+                        GameInfo_t *game);
+
+/**
+ * @brief Plays one snake game through GameModel::UpdateGame() until the snake
+ * dies or wins.
+ * @param options Simulation parameters.
+ * @param seed Seed of the game input and apples.
+ * @return Result of the game.
+ */
+SimResult RunSnakeGame(const SimOptions &options, uint64_t seed);
+
+/**
+ * @brief Plays all games of the run on the worker pool without rendering or
+ * sleeping.
+ * @param options Simulation parameters.
+ * @return Results and timing of the run.
+ */
+SimReport RunSimulation(const SimOptions &options);
+
+/**
+ * @brief Prints throughput and score distribution of a run.
+ * @param options Simulation parameters.
+ * @param report Results of the run.
+ * @param out Output stream.
+ */
+void PrintReport(const SimOptions &options, const SimReport &report,
+                 std::ostream &out);
+
+/**
+ * @brief Re-simulates a recorded session at full speed and checks that it
+ * ends in the recorded state.
+ * @param path Path to the replay file.
+ * @param out Output stream for the report.
+ * @return true if the replay was read and re-simulated and its final state
+ * hash matches.
+ */
+bool RunReplay(const std::string &path, std::ostream &out);
+
+/**
+ * @brief Jumps to a step of a recorded session through its nearest
+ * checkpoint and prints the state there.
+ * @param path Path to the replay file.
+ * @param step Step to seek to, clamped to the length of the session.
+ * @param out Output stream for the report.
+ * @return true if the replay was read and its state rebuilt.
+ */
+bool RunSeek(const std::string &path, unsigned long step, std::ostream &out);
+
+/**
+ * @brief Reads scripted input from a file.
+ *
+ * Every non-space character is one tick: l, r, u, d for the arrows, x for
+ * action and . for no input.
+ *
+ * @param path Path to the script file.
+ * @param script Output vector of actions.
+ * @return true if the file was read and contains at least one action.
+ */
+bool LoadScript(const std::string &path, std::vector<UserAction_t> *script);
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file work_pool.h
+ * @brief Header file containing the work-stealing pool that spreads
+ * independent simulated games over worker threads.
+ */
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class WorkPool
+ * @brief Runs a numbered batch of independent tasks on several threads.
+ *
+ * Every worker starts with a contiguous slice of task indices and takes them
+ * from the front of its slice. A worker that runs dry steals the back half
+ * of the largest remaining slice, so uneven task lengths still keep all
+ * threads busy while the common path only touches the worker's own lock.
+ */
+class WorkPool {
+ public:
+  /**
+   * @brief Task callback: index of the task and index of the worker running
+   * it, from 0 to Threads() - 1.
+   */
+  using Task = std::function<void(int index, int worker)>;
+
+  /**
+   * @brief Creates a pool.
+   * @param threads Number of workers, 0 for one per hardware thread.
+   */
+  explicit WorkPool(int threads);
+
+  /**
+   * @brief Returns the number of workers.
+   * @return Number of workers, at least 1.
+   */
+  int Threads() const;
+
+  /**
+   * @brief Runs task(i, worker) for every i in [0, count) and returns when
+   * all of them are finished. The calling thread is worker 0.
+   * @param count Number of tasks.
+   * @param task Task callback, called concurrently from several threads.
+   */
+  void Run(int count, const Task &task);
+
+ private:
+  /**
+   * @struct Slice
+   * @brief Half-open range of task indices owned by one worker.
+   */
+  struct alignas(64) Slice {
+    std::mutex mutex;
+    int begin = 0;
+    int end = 0;
+  };
+
+  /**
+   * @brief Takes the next task of the worker's own slice.
+   * @param worker Index of the worker.
+   * @param index Output task index.
+   * @return true if a task was taken.
+   */
+  bool Pop(int worker, int *index);
+
+  /**
+   * @brief Moves the back half of the largest other slice to the worker.
+   * @param worker Index of the worker.
+   * @return true if anything was stolen.
+   */
+  bool Steal(int worker);
+
+  /**
+   * @brief Worker loop: runs own tasks, then steals until nothing is left.
+   * @param worker Index of the worker.
+   * @param task Task callback.
+   */
+  void Work(int worker, const Task &task);
+
+  int threads_;                                 /**< Number of workers. */
+  std::vector<std::unique_ptr<Slice>> slices_;  /**< Slice of each worker. */
+};
+
+}  // namespace s21
+
+#endif
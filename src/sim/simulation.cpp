@@ -0,0 +1,311 @@
+#include "inc/simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+#include "../brick_game/snake/controller/inc/game_controller.h"
+#include "../brick_game/snake/model/inc/snake_bot.h"
+#include "../brick_game/tetris/inc/bot.h"
+#include "../brick_game/tetris/inc/fsm_t.h"
+#include "inc/work_pool.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr UserAction_t kTetrisInput[] = {IDLE, IDLE, IDLE, IDLE, IDLE,
+                                         Left, Right, Up,   Down, Action};
+constexpr UserAction_t kSnakeInput[] = {IDLE, IDLE, IDLE, IDLE, IDLE,
+                                        IDLE, Left, Right, Up,  Down};
+
+template <size_t N>
+UserAction_t NextAction(const SimOptions &options, std::mt19937 &input_rng,
+                        long tick, const UserAction_t (&input)[N]) {
+  if (!options.script.empty()) {
+    return options.script[tick % options.script.size()];
+  }
+  std::uniform_int_distribution<size_t> dist(0, N - 1);
+  return input[dist(input_rng)];
+}
+
+int Percentile(const std::vector<int> &sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+/**
+ * @brief Reads a replay recorded by this engine version.
+ * @param path Path to the replay file.
+ * @param replay Replay to fill, left empty on failure.
+ * @param out Output stream for errors.
+ * @return true if the replay can be re-simulated.
+ */
+bool LoadReplay(const std::string &path, Replay *replay, std::ostream &out) {
+  if (!replay_load(replay, path.c_str())) {
+    out << "cannot read replay " << path << '\n';
+    return false;
+  }
+  if (replay->engine_version != REPLAY_ENGINE_VERSION) {
+    out << "replay recorded with engine version " << replay->engine_version
+        << ", this build is " << REPLAY_ENGINE_VERSION << '\n';
+    replay_free(replay);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+uint64_t GameSeed(const SimOptions &options, int index) {
+  Rng rng;
+  rng_seed(&rng, (static_cast<uint64_t>(options.seed) << 32) ^
+                     static_cast<uint32_t>(index));
+  return rng_next(&rng);
+}
+
+SimResult RunTetrisGame(const SimOptions &options, uint64_t seed,
+                        GameInfo_t *game) {
+  std::mt19937 input_rng(static_cast<std::mt19937::result_type>(seed));
+  piece_generator_init(game->generator, options.pieces, seed >> 32);
+  reset_game(game);
+  spawn_new(game);
+  game->action = Start;
+  calculate_game(game);
+  TetrisBot bot;
+  tetris_bot_init(&bot, options.bot);
+
+  long ticks = 0;
+  while (game->status != GAMEOVER && game->status != Terminate &&
+         ticks < options.max_ticks) {
+    game->action = options.bot
+                       ? tetris_bot_action(&bot, game)
+                       : NextAction(options, input_rng, ticks, kTetrisInput);
+    calculate_game(game);
+    ++ticks;
+  }
+
+  return SimResult{game->score, ticks};
+}
+
+SimResult RunSnakeGame(const SimOptions &options, uint64_t seed) {
+  std::mt19937 input_rng(static_cast<std::mt19937::result_type>(seed));
+  GameModel model(false, seed);
+  GameController controller(&model);
+  controller.userInput(Start, false);
+  SnakeBot bot;
+
+  long ticks = 0;
+  int score = 0;
+  while (model.GetGameState() == Running && ticks < options.max_ticks) {
+    UserAction_t action =
+        options.bot ? bot.NextAction(model)
+                    : NextAction(options, input_rng, ticks, kSnakeInput);
+    if (action != IDLE) controller.userInput(action, false);
+    score = model.GetScore();
+    model.UpdateGame();
+    ++ticks;
+  }
+  if (model.GetGameState() != GameOver) score = model.GetScore();
+
+  return SimResult{score, ticks};
+}
+
+SimReport RunSimulation(const SimOptions &options) {
+  SimReport report;
+  report.results.resize(options.games);
+  WorkPool pool(options.threads);
+  report.threads = pool.Threads();
+  // One reusable game per worker, allocated by the worker on first use.
+  std::vector<GameInfo_t *> arenas(pool.Threads(), nullptr);
+  std::atomic<int> failed(0);
+
+  auto start = std::chrono::steady_clock::now();
+  pool.Run(options.games, [&](int index, int worker) {
+    uint64_t seed = GameSeed(options, index);
+    if (options.game == SimGame::tetris) {
+      if (arenas[worker] == nullptr) {
+        arenas[worker] = game_init_seeded(options.pieces, seed);
+      }
+      if (arenas[worker] == nullptr) {
+        report.results[index] = SimResult{0, 0};
+        ++failed;
+        return;
+      }
+      report.results[index] = RunTetrisGame(options, seed, arenas[worker]);
+    } else {
+      report.results[index] = RunSnakeGame(options, seed);
+    }
+  });
+  auto end = std::chrono::steady_clock::now();
+  for (GameInfo_t *game : arenas) free_game_init(game);
+  report.failed = failed.load();
+  report.seconds = std::chrono::duration<double>(end - start).count();
+  return report;
+}
+
+void PrintReport(const SimOptions &options, const SimReport &report,
+                 std::ostream &out) {
+  if (report.results.empty()) {
+    out << "no games played\n";
+    return;
+  }
+
+  long total_ticks = 0;
+  double total_score = 0;
+  std::vector<int> scores;
+  scores.reserve(report.results.size());
+  for (const auto &result : report.results) {
+    total_ticks += result.ticks;
+    total_score += result.score;
+    scores.push_back(result.score);
+  }
+  std::sort(scores.begin(), scores.end());
+
+  double seconds = report.seconds > 0 ? report.seconds : 1e-9;
+  out << std::fixed << std::setprecision(1);
+  out << "game:       "
+      << (options.game == SimGame::tetris ? "tetris" : "snake") << '\n';
+  out << "games:      " << scores.size() << '\n';
+  out << "threads:    " << report.threads << '\n';
+  out << "ticks:      " << total_ticks << '\n';
+  out << "time:       " << std::setprecision(3) << report.seconds << " s\n";
+  out << std::setprecision(1);
+  out << "games/sec:  " << scores.size() / seconds << '\n';
+  out << "ticks/sec:  " << total_ticks / seconds << '\n';
+  out << "score min:  " << scores.front() << '\n';
+  out << "score mean: " << total_score / scores.size() << '\n';
+  out << "score p50:  " << Percentile(scores, 0.5) << '\n';
+  out << "score p90:  " << Percentile(scores, 0.9) << '\n';
+  out << "score p99:  " << Percentile(scores, 0.99) << '\n';
+  out << "score max:  " << scores.back() << '\n';
+
+  const int buckets = 10;
+  int low = scores.front();
+  int width = std::max(1, (scores.back() - low) / buckets + 1);
+  std::vector<size_t> histogram(buckets, 0);
+  for (int score : scores) ++histogram[(score - low) / width];
+  out << "score histogram:\n";
+  for (int i = 0; i < buckets; ++i) {
+    if (histogram[i] == 0) continue;
+    out << "  [" << std::setw(6) << low + i * width << ", " << std::setw(6)
+        << low + (i + 1) * width << ") " << histogram[i] << '\n';
+  }
+}
+
+bool RunReplay(const std::string &path, std::ostream &out) {
+  Replay replay;
+  if (!LoadReplay(path, &replay, out)) return false;
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t hash = replay.game == REPLAY_TETRIS ? replay_tetris(&replay)
+                                               : ReplaySnake(&replay);
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  if (replay.game == REPLAY_TETRIS && hash == 0) {
+    out << "out of memory\n";
+    replay_free(&replay);
+    return false;
+  }
+
+  bool match = hash == replay.final_hash;
+  out << "game:       " << (replay.game == REPLAY_TETRIS ? "tetris" : "snake")
+      << '\n';
+  out << "seed:       " << replay.seed << '\n';
+  out << "inputs:     " << replay.count << '\n';
+  out << "steps:      " << replay.steps << '\n';
+  out << "time:       " << std::fixed << std::setprecision(3) << seconds
+      << " s\n";
+  out << std::hex << "hash:       " << hash << " (recorded "
+      << replay.final_hash << ")\n"
+      << std::dec;
+  out << "result:     " << (match ? "match" : "MISMATCH") << '\n';
+  replay_free(&replay);
+  return match;
+}
+
+bool RunSeek(const std::string &path, unsigned long step, std::ostream &out) {
+  Replay replay;
+  if (!LoadReplay(path, &replay, out)) return false;
+  step = std::min(step, replay.steps);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t hash = 0;
+  int score = 0, level = 0;
+  if (replay.game == REPLAY_TETRIS) {
+    GameInfo_t *game = seek_tetris(&replay, step);
+    if (game == nullptr) {
+      out << "out of memory\n";
+      replay_free(&replay);
+      return false;
+    }
+    hash = hash_game(game);
+    score = game->score;
+    level = game->level;
+    free_game_init(game);
+  } else {
+    GameModel model(false, replay.seed);
+    SeekSnake(&replay, step, &model);
+    hash = model.StateHash();
+    score = model.GetScore();
+    level = model.GetLevel();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  const ReplayCheckpoint *checkpoint = replay_find_checkpoint(&replay, step);
+  out << "game:       " << (replay.game == REPLAY_TETRIS ? "tetris" : "snake")
+      << '\n';
+  out << "step:       " << step << " of " << replay.steps << '\n';
+  out << "checkpoint: ";
+  if (checkpoint != nullptr) {
+    out << "step " << checkpoint->step << '\n';
+  } else {
+    out << "none, from the seed\n";
+  }
+  out << "time:       " << std::fixed << std::setprecision(3) << seconds
+      << " s\n";
+  out << "score:      " << score << '\n';
+  out << "level:      " << level << '\n';
+  out << std::hex << "hash:       " << hash << '\n' << std::dec;
+  replay_free(&replay);
+  return true;
+}
+
+bool LoadScript(const std::string &path, std::vector<UserAction_t> *script) {
+  std::ifstream file(path);
+  if (!file.is_open()) return false;
+
+  script->clear();
+  char ch;
+  while (file >> ch) {
+    switch (ch) {
+    case 'l':
+      script->push_back(Left);
+      break;
+    case 'r':
+      script->push_back(Right);
+      break;
+    case 'u':
+      script->push_back(Up);
+      break;
+    case 'd':
+      script->push_back(Down);
+      break;
+    case 'x':
+      script->push_back(Action);
+      break;
+    case '.':
+      script->push_back(IDLE);
+      break;
+    default:
+      return false;
+    }
+  }
+  return !script->empty();
+}
+
+}  // namespace s21
@@ -0,0 +1,78 @@
+#include "inc/work_pool.h"
+
+#include <thread>
+
+namespace s21 {
+
+WorkPool::WorkPool(int threads) : threads_(threads) {
+  if (threads_ <= 0) {
+    threads_ = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  if (threads_ <= 0) threads_ = 1;
+  for (int i = 0; i < threads_; ++i) {
+    slices_.push_back(std::make_unique<Slice>());
+  }
+}
+
+int WorkPool::Threads() const { return threads_; }
+
+void WorkPool::Run(int count, const Task &task) {
+  for (int i = 0; i < threads_; ++i) {
+    slices_[i]->begin = static_cast<int>(static_cast<long>(count) * i / threads_);
+    slices_[i]->end =
+        static_cast<int>(static_cast<long>(count) * (i + 1) / threads_);
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads_ - 1);
+  for (int i = 1; i < threads_; ++i) {
+    workers.emplace_back([this, i, &task]() { Work(i, task); });
+  }
+  Work(0, task);
+  for (auto &worker : workers) worker.join();
+}
+
+bool WorkPool::Pop(int worker, int *index) {
+  Slice &slice = *slices_[worker];
+  std::lock_guard<std::mutex> lock(slice.mutex);
+  if (slice.begin >= slice.end) return false;
+  *index = slice.begin++;
+  return true;
+}
+
+bool WorkPool::Steal(int worker) {
+  while (true) {
+    int victim = -1;
+    int largest = 0;
+    for (int i = 0; i < threads_; ++i) {
+      if (i == worker) continue;
+      std::lock_guard<std::mutex> lock(slices_[i]->mutex);
+      int left = slices_[i]->end - slices_[i]->begin;
+      if (left > largest) {
+        largest = left;
+        victim = i;
+      }
+    }
+    if (victim < 0) return false;
+
+    Slice &from = *slices_[victim];
+    Slice &to = *slices_[worker];
+    std::scoped_lock lock(from.mutex, to.mutex);
+    int left = from.end - from.begin;
+    if (left <= 0) continue;
+    int middle = from.end - (left + 1) / 2;
+    to.begin = middle;
+    to.end = from.end;
+    from.end = middle;
+    return true;
+  }
+}
+
+void WorkPool::Work(int worker, const Task &task) {
+  int index = 0;
+  do {
+    while (Pop(worker, &index)) task(index, worker);
+  } while (Steal(worker));
+}
+
+}  // namespace s21
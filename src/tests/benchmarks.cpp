@@ -0,0 +1,228 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../brick_game/snake/controller/inc/game_controller.h"
+#include "../brick_game/snake/model/inc/game_model.h"
+#include "../brick_game/snake/model/inc/snake_bot.h"
+#include "../brick_game/tetris/inc/backend.h"
+#include "../brick_game/tetris/inc/batch.h"
+#include "../brick_game/tetris/inc/bot.h"
+#include "../brick_game/tetris/inc/fsm_t.h"
+
+namespace {
+
+// Fills the given percentage of the field rows, counted from the bottom, with
+// blocks. Every row keeps one hole, so no line is complete.
+void fill_field(GameInfo_t *game, int percent) {
+  int rows = FIELD_HEIGHT * percent / 100;
+  for (int i = FIELD_HEIGHT - rows; i < FIELD_HEIGHT; i++) {
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      game->field[i][j] = j == (i * 7) % FIELD_WIDTH ? 0 : 1 + (i + j) % 7;
+    }
+  }
+}
+
+// Random play: mostly shifts and turns, with an occasional hard drop.
+std::vector<uint8_t> make_actions(int count) {
+  static const UserAction_t choices[] = {Left, Right, Up, Down, IDLE,
+                                         IDLE, Left,  Right, Up, Action};
+  std::vector<uint8_t> actions(count);
+  Rng rng;
+  rng_seed(&rng, 42);
+  for (uint8_t &action : actions) action = choices[rng_below(&rng, 10)];
+  return actions;
+}
+
+s21::Snake make_snake(int length) {
+  s21::Snake snake;
+  for (int i = 4; i < length; ++i) snake.Grow();
+  return snake;
+}
+
+}  // namespace
+
+static void BM_Collision(benchmark::State &state) {
+  GameInfo_t *game = game_init();
+  fill_field(game, state.range(0));
+  game->figure->y = FIELD_HEIGHT - 4;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(collision(game));
+  }
+  free_game_init(game);
+}
+BENCHMARK(BM_Collision)->Arg(0)->Arg(25)->Arg(50)->Arg(75)->Arg(95);
+
+static void BM_EraseAndScore(benchmark::State &state) {
+  GameInfo_t *game = game_init();
+  int full_rows = FIELD_HEIGHT * state.range(0) / 100;
+  for (auto _ : state) {
+    for (int i = FIELD_HEIGHT - full_rows; i < FIELD_HEIGHT; i++) {
+      for (int j = 0; j < FIELD_WIDTH; j++) game->field[i][j] = 1;
+    }
+    game->score = 0;
+    erase_and_score(game);
+    benchmark::DoNotOptimize(game->score);
+  }
+  free_game_init(game);
+}
+BENCHMARK(BM_EraseAndScore)->Arg(0)->Arg(5)->Arg(10)->Arg(20);
+
+static void BM_Rotate(benchmark::State &state) {
+  GameInfo_t *game = game_init();
+  for (auto _ : state) {
+    rotate(game);
+    benchmark::DoNotOptimize(game->figure);
+  }
+  free_game_init(game);
+}
+BENCHMARK(BM_Rotate);
+
+static void BM_PlaceFigureOnField(benchmark::State &state) {
+  GameInfo_t *game = game_init();
+  fill_field(game, state.range(0));
+  for (auto _ : state) {
+    place_figure_on_field(game);
+    clear_figure_from_field(game);
+    benchmark::ClobberMemory();
+  }
+  free_game_init(game);
+}
+BENCHMARK(BM_PlaceFigureOnField)->Arg(0)->Arg(50)->Arg(95);
+
+static void BM_TetrisStep(benchmark::State &state) {
+  int count = state.range(0);
+  std::vector<GameInfo_t *> games;
+  for (int i = 0; i < count; i++) {
+    games.push_back(game_init_seeded(PIECES_BAG, i));
+    spawn_new(games[i]);
+    apply_user_action(games[i], Start);
+  }
+  std::vector<uint8_t> actions = make_actions(count * 64);
+  size_t step = 0;
+  for (auto _ : state) {
+    const uint8_t *row = &actions[step++ % 64 * count];
+    for (int i = 0; i < count; i++) {
+      GameInfo_t *game = games[i];
+      if (game->status == GAMEOVER) {
+        reset_game(game);
+        spawn_new(game);
+        apply_user_action(game, Start);
+      }
+      game->action = (UserAction_t)row[i];
+      calculate_game(game);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  for (GameInfo_t *game : games) free_game_init(game);
+}
+BENCHMARK(BM_TetrisStep)->Arg(64)->Arg(1024);
+
+static void BM_TetrisBatchStep(benchmark::State &state) {
+  int count = state.range(0);
+  TetrisBatch *batch = tetris_batch_init(count);
+  batch->simd = state.range(1) && tetris_batch_simd_available();
+  std::vector<uint8_t> start(count, Start);
+  for (int i = 0; i < count; i++) tetris_batch_reset(batch, i, PIECES_BAG, i);
+  tetris_batch_step(batch, start.data());
+  std::vector<uint8_t> actions = make_actions(count * 64);
+  size_t step = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < count; i++) {
+      if (batch->over[i]) {
+        tetris_batch_reset(batch, i, PIECES_BAG, step);
+        batch->status[i] = Start;
+      }
+    }
+    tetris_batch_step(batch, &actions[step++ % 64 * count]);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  tetris_batch_free(batch);
+}
+BENCHMARK(BM_TetrisBatchStep)
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({1024, 0})
+    ->Args({1024, 1});
+
+static void BM_TetrisBotPlan(benchmark::State &state) {
+  GameInfo_t *game = game_init_seeded(PIECES_BAG, 5);
+  spawn_new(game);
+  apply_user_action(game, Start);
+  TetrisBot bot;
+  tetris_bot_init(&bot, state.range(0));
+  // Plays a while first so the field is a mid-game one.
+  for (int step = 0; step < 2000 && game->status != GAMEOVER; step++) {
+    game->action = tetris_bot_action(&bot, game);
+    calculate_game(game);
+  }
+  int rotation = 0, x = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tetris_bot_plan(&bot, game, &rotation, &x));
+  }
+  free_game_init(game);
+}
+BENCHMARK(BM_TetrisBotPlan)->Arg(1)->Arg(2);
+
+static void BM_SnakeMove(benchmark::State &state) {
+  s21::Snake snake = make_snake(state.range(0));
+  const s21::Direction square[] = {s21::Direction::right,
+                                   s21::Direction::down, s21::Direction::left,
+                                   s21::Direction::up};
+  int step = 0;
+  for (auto _ : state) {
+    snake.ChangeDirection(square[(step++ / 4) % 4]);
+    snake.Move();
+    benchmark::DoNotOptimize(snake.GetHeadPosition());
+  }
+}
+BENCHMARK(BM_SnakeMove)->Arg(4)->Arg(16)->Arg(64)->Arg(200);
+
+static void BM_SnakeCheckSelfCollision(benchmark::State &state) {
+  s21::Snake snake = make_snake(state.range(0));
+  snake.Move();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(snake.CheckSelfCollision());
+  }
+}
+BENCHMARK(BM_SnakeCheckSelfCollision)->Arg(4)->Arg(16)->Arg(64)->Arg(200);
+
+static void BM_AppleSpawnApple(benchmark::State &state) {
+  s21::Apple apple;
+  s21::FreeCells free_cells;
+  for (int i = 0; i < state.range(0); ++i) {
+    free_cells.Occupy(s21::Position(i % FIELD_WIDTH, i / FIELD_WIDTH));
+  }
+  for (auto _ : state) {
+    apple.SpawnApple(free_cells);
+    benchmark::DoNotOptimize(apple.GetPosition());
+  }
+}
+BENCHMARK(BM_AppleSpawnApple)->Arg(4)->Arg(64)->Arg(150)->Arg(195);
+
+static void BM_GameModelUpdateCurrentState(benchmark::State &state) {
+  s21::GameModel model;
+  for (auto _ : state) {
+    GameInfo_t info = model.UpdateCurrentState();
+    benchmark::DoNotOptimize(info.field);
+  }
+}
+BENCHMARK(BM_GameModelUpdateCurrentState);
+
+static void BM_SnakeBotNextAction(benchmark::State &state) {
+  s21::GameModel model(false, 1);
+  s21::GameController controller(&model);
+  model.SetGameState(Running);
+  s21::SnakeBot bot;
+  for (auto _ : state) {
+    controller.userInput(bot.NextAction(model), false);
+    model.UpdateGame();
+    if (model.GetGameState() != Running) {
+      model.Restart(1);
+      model.SetGameState(Running);
+    }
+  }
+}
+BENCHMARK(BM_SnakeBotNextAction);
+
+BENCHMARK_MAIN();
@@ -1,13 +1,50 @@
+#include <atomic>
 #include <cstdio>
 #include <gtest/gtest.h>
 #include <memory>
+#include <random>
+#include <thread>
+#include <unistd.h>
 #include <ncurses.h>
 #include <vector>
 
+#include "../brick_game/api/inc/brickgame.h"
+#include "../brick_game/common/inc/game_thread.h"
 #include "../brick_game/tetris/inc/backend.h"
+#include "../brick_game/tetris/inc/batch.h"
+#include "../brick_game/tetris/inc/bitboard.h"
+#include "../brick_game/tetris/inc/bot.h"
 #include "../brick_game/tetris/inc/fsm_t.h"
 
 #include "../brick_game/snake/controller/inc/game_controller.h"
+#include "../brick_game/snake/model/inc/snake_bot.h"
+#include "../sim/inc/simulation.h"
+#include "../sim/inc/work_pool.h"
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define COUNT_ALLOCATIONS
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+// Number of heap allocations made by the test binary, C++ ones included.
+static std::atomic<long> allocation_count{0};
+
+extern "C" void *malloc(size_t size) noexcept {
+  allocation_count++;
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept {
+  allocation_count++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept {
+  allocation_count++;
+  return __libc_realloc(ptr, size);
+}
+#endif
 
 namespace s21 {
 
@@ -84,6 +121,38 @@ TEST_F(AppleTest, SpawnApple_WithOccupiedPositions) {
   EXPECT_FALSE(is_occupied);
 }
 
+TEST_F(AppleTest, SpawnApple_FreeCells) {
+  FreeCells free_cells;
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    for (int x = 0; x < FIELD_WIDTH; ++x) {
+      if (x != 7 || y != 13) free_cells.Occupy(Position(x, y));
+    }
+  }
+  apple.SpawnApple(free_cells);
+  EXPECT_EQ(apple.GetPosition(), Position(7, 13));
+}
+
+TEST(FreeCellsTest, OccupyAndRelease) {
+  FreeCells free_cells;
+  EXPECT_EQ(free_cells.Size(), FIELD_WIDTH * FIELD_HEIGHT);
+  free_cells.Occupy(Position(0, 0));
+  free_cells.Occupy(Position(0, 0));
+  free_cells.Occupy(Position(3, 4));
+  free_cells.Occupy(Position(-1, 4));
+  EXPECT_EQ(free_cells.Size(), FIELD_WIDTH * FIELD_HEIGHT - 2);
+  EXPECT_FALSE(free_cells.IsFree(Position(3, 4)));
+  EXPECT_TRUE(free_cells.IsFree(Position(4, 3)));
+  for (int i = 0; i < free_cells.Size(); ++i) {
+    EXPECT_TRUE(free_cells.IsFree(free_cells.At(i)));
+  }
+  free_cells.Release(Position(3, 4));
+  free_cells.Release(Position(3, 4));
+  EXPECT_TRUE(free_cells.IsFree(Position(3, 4)));
+  EXPECT_EQ(free_cells.Size(), FIELD_WIDTH * FIELD_HEIGHT - 1);
+  free_cells.Reset();
+  EXPECT_TRUE(free_cells.IsFree(Position(0, 0)));
+}
+
 class GameModelTest : public ::testing::Test {
 protected:
   GameModel game_model_;
@@ -96,6 +165,16 @@ protected:
   void TearDown() override {}
 };
 
+TEST_F(GameModelTest, TimeToUpdate) {
+  EXPECT_EQ(game_model_.GetTimeToUpdate(), -1);
+  game_model_.SetGameState(Running);
+  int left = game_model_.GetTimeToUpdate();
+  EXPECT_GE(left, 0);
+  EXPECT_LE(left, BASE_SPEED_S);
+  game_model_.SetGameState(Paused);
+  EXPECT_EQ(game_model_.GetTimeToUpdate(), -1);
+}
+
 TEST_F(GameModelTest, InitialState) {
   EXPECT_EQ(game_model_.GetGameState(), Paused);
   GameInfo_t info = game_model_.UpdateCurrentState();
@@ -148,6 +227,39 @@ TEST_F(GameModelTest, CheckWin) {
   EXPECT_EQ(game_model_.GetGameState(), Win);
 }
 
+TEST(GameModelDirtyCellsTest, UpdateCurrentState_DirtyCells) {
+  // A fixed seed keeps the apple off the head's next cell, so the first step
+  // only moves the snake.
+  GameModel game_model(false, 1);
+  Snake snake;
+  snake.Move();
+  ASSERT_FALSE(game_model.GetApple().GetPosition() ==
+               snake.GetHeadPosition());
+
+  GameInfo_t info = game_model.UpdateCurrentState();
+  EXPECT_EQ(info.changed_cells, FIELD_WIDTH * FIELD_HEIGHT);
+  info = game_model.UpdateCurrentState();
+  EXPECT_EQ(info.changed_cells, 0);
+  EXPECT_TRUE(game_model.GetDirtyCells().empty());
+
+  game_model.SetGameState(Running);
+  game_model.UpdateGame();
+  info = game_model.UpdateCurrentState();
+  EXPECT_EQ(info.changed_cells, 2);
+
+  int apples = 0;
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    for (int x = 0; x < FIELD_WIDTH; ++x) {
+      if (info.field[y][x] == 2) {
+        ++apples;
+      } else {
+        EXPECT_EQ(info.field[y][x], snake.IsOccupied(Position(x, y)) ? 3 : 0);
+      }
+    }
+  }
+  EXPECT_EQ(apples, 1);
+}
+
 class ScoreTest : public ::testing::Test {
 
 protected:
@@ -255,6 +367,35 @@ TEST_F(SnakeTest, CheckSelfCollision_NoCollision) {
   EXPECT_FALSE(snake.CheckSelfCollision());
 }
 
+TEST_F(SnakeTest, CheckSelfCollision_Collision) {
+  for (int i = 0; i < 3; ++i) snake.Grow();
+  const Direction turns[] = {Direction::left, Direction::down,
+                             Direction::right};
+  for (Direction dir : turns) {
+    snake.ChangeDirection(dir);
+    snake.Move();
+  }
+  bool expected = false;
+  const auto &body = snake.GetBody();
+  for (size_t i = 1; i < body.size(); ++i) {
+    expected = expected || body[i].position == snake.GetHeadPosition();
+  }
+  EXPECT_TRUE(expected);
+  EXPECT_TRUE(snake.CheckSelfCollision());
+}
+
+TEST_F(SnakeTest, IsOccupied) {
+  EXPECT_TRUE(snake.IsOccupied(Position(FIELD_WIDTH / 2, FIELD_HEIGHT / 2 + 3)));
+  snake.Move();
+  EXPECT_FALSE(
+      snake.IsOccupied(Position(FIELD_WIDTH / 2, FIELD_HEIGHT / 2 + 3)));
+  EXPECT_TRUE(snake.IsOccupied(Position(FIELD_WIDTH / 2, FIELD_HEIGHT / 2 - 1)));
+  EXPECT_FALSE(snake.IsOccupied(Position(-1, 0)));
+  snake.Grow();
+  snake.Move();
+  EXPECT_TRUE(snake.IsOccupied(Position(FIELD_WIDTH / 2, FIELD_HEIGHT / 2 + 2)));
+}
+
 class TimerTest : public ::testing::Test {
 protected:
   GameModel game_model_;
@@ -301,7 +442,9 @@ TEST(brick_game_tests, GameInit) {
 }
 
 TEST(brick_game_tests, InitGameField) {
-  int **field = init_game_field();
+  FieldRow *field = init_game_field();
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(field) % FIELD_ALIGN, 0u);
+  ASSERT_EQ(&field[1][0] - &field[0][0], FIELD_STRIDE);
   for (int i = 0; i < FIELD_HEIGHT; i++) {
     for (int j = 0; j < FIELD_WIDTH; j++) {
       ASSERT_EQ(field[i][j], 0);
@@ -311,7 +454,7 @@ TEST(brick_game_tests, InitGameField) {
 }
 
 TEST(brick_game_tests, InitFigure) {
-  Figure *figure = init_figure(FIGURE_START_X, FIGURE_START_Y);
+  Figure *figure = init_figure(3, FIGURE_START_X, FIGURE_START_Y);
   ASSERT_GE(figure->figure_num, 0);
   ASSERT_LT(figure->figure_num, FIGURES_COUNT);
   ASSERT_EQ(figure->x, FIGURE_START_X);
@@ -322,7 +465,7 @@ TEST(brick_game_tests, InitFigure) {
 TEST(brick_game_tests, InitFigureValidInputs) {
   int figure_x = 5;
   int figure_y = 5;
-  Figure *f = init_figure(figure_x, figure_y);
+  Figure *f = init_figure(0, figure_x, figure_y);
 
   ASSERT_NE(f, nullptr);
   ASSERT_EQ(f->x, figure_x);
@@ -339,7 +482,7 @@ TEST(brick_game_tests, InitFigureValidInputs) {
 TEST(brick_game_tests, InitFigureInvalidInputs) {
   int figure_x = -1;
   int figure_y = -1;
-  Figure *f = init_figure(figure_x, figure_y);
+  Figure *f = init_figure(6, figure_x, figure_y);
 
   ASSERT_NE(f, nullptr);
   ASSERT_EQ(f->x, figure_x);
@@ -353,8 +496,90 @@ TEST(brick_game_tests, InitFigureInvalidInputs) {
   free_figure(f);
 }
 
+TEST(brick_game_tests, PieceLifecycleDoesNotAllocate) {
+#ifndef COUNT_ALLOCATIONS
+  GTEST_SKIP() << "allocation counting needs glibc";
+#else
+  GameInfo_t *game = game_init_seeded(PIECES_BAG, 11);
+  spawn_new(game);
+  apply_user_action(game, Start);
+  const UserAction_t moves[] = {Left, Up, Right, Down, Left, Left};
+
+  long dealt = game->generator->dealt;
+  long before = allocation_count.load();
+  for (int piece = 0; piece < 10000; piece++) {
+    if (piece % 1000 == 999) {
+      reset_game(game);
+      apply_user_action(game, Start);
+    }
+    apply_user_action(game, moves[piece % 6]);
+    tick_game(game);
+    apply_user_action(game, Action);
+    for (int i = 0; i < FIGURE_SIZE + 1; i++) {
+      for (int j = 0; j < FIELD_WIDTH; j++) {
+        if (game->field[i][j] != 0) memset(game->field, 0, FIELD_BYTES);
+      }
+    }
+  }
+  long allocations = allocation_count.load() - before;
+  dealt = game->generator->dealt - dealt;
+
+  ASSERT_EQ(game->status, Start);
+  free_game_init(game);
+  // Every Action plants the piece and deals the next one; resets deal a few
+  // more.
+  EXPECT_NEAR(dealt, 10000, 100);
+  ASSERT_EQ(allocations, 0);
+#endif
+}
+
+TEST(brick_game_tests, PieceGeneratorBagDealsEveryFigure) {
+  PieceGenerator generator;
+  piece_generator_init(&generator, PIECES_BAG, 42);
+  for (int bag = 0; bag < 100; bag++) {
+    int seen[FIGURES_COUNT] = {0};
+    for (int i = 0; i < FIGURES_COUNT; i++) {
+      int piece = piece_generator_next(&generator);
+      ASSERT_GE(piece, 0);
+      ASSERT_LT(piece, FIGURES_COUNT);
+      seen[piece]++;
+    }
+    for (int count : seen) ASSERT_EQ(count, 1);
+  }
+}
+
+TEST(brick_game_tests, PieceGeneratorSeedIsReproducible) {
+  for (PieceMode mode : {PIECES_UNIFORM, PIECES_BAG, PIECES_TGM}) {
+    GameInfo_t *first = game_init_seeded(mode, 7);
+    GameInfo_t *second = game_init_seeded(mode, 7);
+    PieceGenerator other;
+    piece_generator_init(&other, mode, 8);
+    int differs = 0;
+    for (int i = 0; i < 1000; i++) {
+      ASSERT_EQ(first->figure->figure_num, second->figure->figure_num);
+      if (piece_generator_next(&other) != first->figure->figure_num) differs++;
+      spawn_new(first);
+      spawn_new(second);
+    }
+    ASSERT_GT(differs, 0);
+    free_game_init(first);
+    free_game_init(second);
+  }
+}
+
+TEST(brick_game_tests, PieceGeneratorTgmAvoidsBadStart) {
+  for (uint64_t seed = 0; seed < 200; seed++) {
+    PieceGenerator generator;
+    piece_generator_init(&generator, PIECES_TGM, seed);
+    int piece = piece_generator_next(&generator);
+    ASSERT_NE(piece, 0);
+    ASSERT_NE(piece, 1);
+    ASSERT_NE(piece, 5);
+  }
+}
+
 TEST(brick_game_tests, GetRandomFigure) {
-  Figure *figure = init_figure(0, 0);
+  Figure *figure = init_figure(4, 0, 0);
   get_random_figure(figure);
 
   ASSERT_GE(figure->figure_num, 0);
@@ -547,6 +772,453 @@ TEST(brick_game_tests, CheckTicksTicksLeftPositive) {
   free_game_init(game);
 }
 
+TEST(brick_game_tests, ProcessActionKeepsTicks) {
+  GameInfo_t *game = game_init();
+  spawn_new(game);
+  game->status = Start;
+  game->ticks_left = 1;
+
+  game->action = Left;
+  process_action(game);
+  ASSERT_EQ(game->ticks_left, 1);
+  ASSERT_EQ(ticks_until_gravity(game), 2);
+
+  int y = game->figure->y;
+  tick_game(game);
+  ASSERT_EQ(game->figure->y, y);
+  ASSERT_EQ(ticks_until_gravity(game), 1);
+  tick_game(game);
+  ASSERT_EQ(game->figure->y, y + 1);
+  ASSERT_EQ(game->ticks_left, TICKS_START - 1);
+  ASSERT_EQ(tick_interval_us(game), TICK_DURATION / 1000);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, GameClockFixedStep) {
+  GameClock clock;
+  game_clock_init(&clock, 100, 3);
+  ASSERT_FALSE(game_clock_step(&clock));
+  ASSERT_EQ(game_clock_time_to_step(&clock, 0), -1);
+
+  game_clock_start(&clock, 1000);
+  ASSERT_EQ(game_clock_time_to_step(&clock, 1040), 60);
+  game_clock_update(&clock, 1250);
+  ASSERT_TRUE(game_clock_step(&clock));
+  ASSERT_TRUE(game_clock_step(&clock));
+  ASSERT_FALSE(game_clock_step(&clock));
+  ASSERT_EQ(game_clock_time_to_step(&clock, 1250), 50);
+
+  game_clock_update(&clock, 5000);
+  int steps = 0;
+  while (game_clock_step(&clock)) steps++;
+  ASSERT_EQ(steps, 3);
+
+  game_clock_stop(&clock);
+  game_clock_update(&clock, 9000);
+  ASSERT_FALSE(game_clock_step(&clock));
+}
+
+TEST(brick_game_tests, AdvanceGameIgnoresCallRate) {
+  GameInfo_t *game = game_init();
+  spawn_new(game);
+  game->status = Start;
+  GameClock clock;
+  init_game_clock(game, &clock);
+  long long step = tick_interval_us(game);
+
+  ASSERT_EQ(advance_game(game, &clock, 0), 0);
+  int y = game->figure->y;
+  int ticks = 0;
+  for (long long now = 1; now <= (TICKS_START + 1) * step; now += 7919) {
+    ticks += advance_game(game, &clock, now);
+  }
+  ticks += advance_game(game, &clock, (TICKS_START + 1) * step);
+  ASSERT_EQ(ticks, TICKS_START + 1);
+  ASSERT_EQ(game->figure->y, y + 1);
+
+  game->status = Pause;
+  ASSERT_EQ(advance_game(game, &clock, 100 * step), 0);
+  ASSERT_EQ(time_to_gravity_us(game, &clock, 100 * step), -1);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, InputQueueKeepsOrder) {
+  InputQueue queue;
+  input_queue_init(&queue);
+  InputEvent event = {Left, false, 0};
+  for (int i = 0; i < INPUT_QUEUE_SIZE; i++) {
+    event.time_us = i;
+    ASSERT_TRUE(input_queue_push(&queue, &event));
+  }
+  ASSERT_FALSE(input_queue_push(&queue, &event));
+  for (int i = 0; i < INPUT_QUEUE_SIZE; i++) {
+    ASSERT_TRUE(input_queue_pop(&queue, &event));
+    ASSERT_EQ(event.time_us, i);
+  }
+  ASSERT_FALSE(input_queue_pop(&queue, &event));
+  ASSERT_TRUE(input_queue_empty(&queue));
+}
+
+TEST(brick_game_tests, GameThreadAppliesEveryAction) {
+  std::vector<int> applied;
+  s21::GameThread thread(
+      [&](const InputEvent &event) { applied.push_back(event.action); },
+      [](long long) { return -1LL; });
+  thread.Start();
+  const int count = INPUT_QUEUE_SIZE * 4;
+  for (int i = 0; i < count; i++) {
+    ASSERT_TRUE(thread.Post(static_cast<UserAction_t>(i % 8), false));
+  }
+  thread.Stop();
+  ASSERT_FALSE(thread.Post(Left, false));
+  size_t size = thread.Read([&]() { return applied.size(); });
+  ASSERT_EQ(size, static_cast<size_t>(count));
+  for (int i = 0; i < count; i++) ASSERT_EQ(applied[i], i % 8);
+}
+
+TEST(brick_game_tests, SharedSessionControlsGameThread) {
+  std::string name = "/brickgame_test_" + std::to_string(getpid());
+  SharedSession *session = shared_session_create(name.c_str(), SHARED_TETRIS);
+  ASSERT_NE(session, nullptr);
+  std::vector<int> applied;
+  s21::GameThread thread(
+      [&](const InputEvent &event) { applied.push_back(event.action); },
+      [](long long) { return -1LL; },
+      [&](Frame *frame) { frame->score = static_cast<int>(applied.size()); });
+  thread.Share(session);
+  thread.Start();
+
+  SharedSession *client = shared_session_open(name.c_str());
+  ASSERT_NE(client, nullptr);
+  ASSERT_EQ(client->game, static_cast<uint32_t>(SHARED_TETRIS));
+  ASSERT_TRUE(shared_session_push(client, Left, false));
+  ASSERT_TRUE(shared_session_push(client, static_cast<UserAction_t>(200), 0));
+  ASSERT_TRUE(shared_session_push(client, Up, true));
+  Frame frame = {};
+  for (int i = 0; i < 2000; i++) {
+    if (shared_session_read(client, &frame) && frame.score == 2) break;
+    usleep(1000);
+  }
+  ASSERT_EQ(frame.score, 2);
+  ASSERT_GT(frame.sequence, 0ULL);
+  shared_session_close(client);
+
+  thread.Stop();
+  ASSERT_EQ(applied, std::vector<int>({Left, Up}));
+  shared_session_destroy(session, name.c_str());
+  ASSERT_EQ(shared_session_open(name.c_str()), nullptr);
+}
+
+TEST(brick_game_tests, SharedSessionReadsWholeFrames) {
+  std::string name = "/brickgame_test_" + std::to_string(getpid());
+  SharedSession *session = shared_session_create(name.c_str(), SHARED_SNAKE);
+  ASSERT_NE(session, nullptr);
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    Frame frame = {};
+    for (int i = 1; !done; i++) {
+      memset(frame.field, i & 0xFF, sizeof(frame.field));
+      frame.score = i & 0xFF;
+      shared_session_publish(session, &frame);
+    }
+  });
+  Frame frame;
+  int torn = 0;
+  for (int i = 0; i < 20000; i++) {
+    if (!shared_session_read(session, &frame)) continue;
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      for (int col = 0; col < FIELD_STRIDE; col++) {
+        torn += frame.field[row][col] != frame.score;
+      }
+    }
+  }
+  done = true;
+  writer.join();
+  shared_session_destroy(session, name.c_str());
+  ASSERT_EQ(torn, 0);
+}
+
+TEST(brick_game_tests, SharedSessionKeepsNamesOfOtherGames) {
+  std::string name = "/brickgame_test_" + std::to_string(getpid());
+  SharedSession *session = shared_session_create(name.c_str(), SHARED_TETRIS);
+  ASSERT_NE(session, nullptr);
+  ASSERT_EQ(shared_session_create(name.c_str(), SHARED_SNAKE), nullptr);
+  ASSERT_EQ(session->game, static_cast<uint32_t>(SHARED_TETRIS));
+
+  // A session left behind by a game that died is replaced.
+  session->owner = INT32_MAX;
+  SharedSession *replaced = shared_session_create(name.c_str(), SHARED_SNAKE);
+  ASSERT_NE(replaced, nullptr);
+  session->owner = static_cast<uint32_t>(getpid());
+  shared_session_destroy(session, name.c_str());
+  SharedSession *client = shared_session_open(name.c_str());
+  ASSERT_NE(client, nullptr);
+  ASSERT_EQ(client->game, static_cast<uint32_t>(SHARED_SNAKE));
+
+  // A reader gives up on a frame the writer never finished.
+  Frame frame = {};
+  shared_session_publish(replaced, &frame);
+  ASSERT_TRUE(shared_session_read(client, &frame));
+  replaced->sequence.fetch_add(1);
+  ASSERT_FALSE(shared_session_read(client, &frame));
+  shared_session_close(client);
+
+  shared_session_destroy(replaced, name.c_str());
+  ASSERT_EQ(shared_session_open(name.c_str()), nullptr);
+}
+
+TEST(brick_game_tests, FrameBufferKeepsLatest) {
+  FrameBuffer buffer;
+  frame_buffer_init(&buffer);
+  ASSERT_EQ(frame_buffer_latest(&buffer)->sequence, 0ULL);
+
+  for (unsigned long long i = 1; i <= 3; i++) {
+    Frame *back = frame_buffer_back(&buffer);
+    back->score = static_cast<int>(i) * 10;
+    back->sequence = i;
+    frame_buffer_publish(&buffer);
+  }
+  const Frame *frame = frame_buffer_latest(&buffer);
+  ASSERT_EQ(frame->sequence, 3ULL);
+  ASSERT_EQ(frame->score, 30);
+
+  frame_buffer_back(&buffer)->sequence = 4;
+  ASSERT_EQ(frame_buffer_latest(&buffer), frame);
+  ASSERT_EQ(frame->sequence, 3ULL);
+}
+
+TEST(brick_game_tests, SnapshotGameLeavesFieldIntact) {
+  GameInfo_t *game = game_init();
+  spawn_new(game);
+  game->figure->y = 4;
+  Frame frame;
+  snapshot_game(game, &frame);
+
+  int figure_cells = 0;
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      ASSERT_EQ(game->field[i][j], 0);
+      if (frame.field[i][j] != 0) figure_cells++;
+    }
+  }
+  ASSERT_EQ(figure_cells, 4);
+  ASSERT_EQ(frame.state, game->status);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, TetrisReplayReproducesGame) {
+  GameInfo_t *game = game_init_seeded(PIECES_TGM, 123);
+  spawn_new(game);
+  Replay replay;
+  record_game(game, &replay);
+
+  const UserAction_t moves[] = {Left, Up, Right, Right, Down, Pause, Start};
+  apply_user_action(game, Start);
+  for (int i = 0; i < 3000; i++) {
+    apply_user_action(game, moves[i % 7]);
+    for (int tick = 0; tick < i % 40; tick++) tick_game(game);
+    if (i % 5 == 0) apply_user_action(game, Action);
+    if (game->status == GAMEOVER) {
+      apply_user_action(game, Start);
+      ASSERT_EQ(game->status, RESET);
+      reset_game(game);
+      apply_user_action(game, Start);
+    }
+  }
+  finish_recording(game);
+  ASSERT_EQ(game->recorder, nullptr);
+
+  const char *path = "test_replay.bin";
+  ASSERT_TRUE(replay_save(&replay, path));
+  Replay loaded;
+  ASSERT_TRUE(replay_load(&loaded, path));
+  std::remove(path);
+  ASSERT_EQ(loaded.count, replay.count);
+  ASSERT_EQ(loaded.steps, replay.steps);
+  ASSERT_EQ(loaded.seed, 123u);
+  ASSERT_EQ(replay_tetris(&loaded), hash_game(game));
+  ASSERT_EQ(loaded.checkpoint_count, replay.checkpoint_count);
+  ASSERT_GT(loaded.checkpoint_count, 2u);
+
+  Replay unindexed = loaded;
+  unindexed.checkpoint_count = 0;
+  for (unsigned long step = 0; step <= loaded.steps; step += 97) {
+    GameInfo_t *seeked = seek_tetris(&loaded, step);
+    GameInfo_t *simulated = seek_tetris(&unindexed, step);
+    ASSERT_EQ(hash_game(seeked), hash_game(simulated));
+    free_game_init(seeked);
+    free_game_init(simulated);
+  }
+
+  unindexed.seed++;
+  ASSERT_NE(replay_tetris(&unindexed), hash_game(game));
+
+  const ReplayCheckpoint *last = replay_find_checkpoint(&loaded, loaded.steps);
+  ASSERT_TRUE(restore_game(game, replay_checkpoint_state(&loaded, last),
+                           last->size));
+  ASSERT_FALSE(restore_game(game, replay_checkpoint_state(&loaded, last),
+                            last->size - 1));
+  replay_free(&loaded);
+  replay_free(&replay);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, RestoreRejectsCorruptedCheckpoint) {
+  GameInfo_t *game = game_init_seeded(PIECES_BAG, 7);
+  spawn_new(game);
+  apply_user_action(game, Start);
+  for (int i = 0; i < 200; i++) tick_game(game);
+  uint8_t state[TETRIS_CHECKPOINT_SIZE];
+  ASSERT_EQ(checkpoint_game(game, state), (size_t)TETRIS_CHECKPOINT_SIZE);
+  uint64_t hash = hash_game(game);
+
+  // Offsets of the figure x and y, the level, the status and the ticks.
+  const size_t figure = CHECKPOINT_COLOR_PLANES * FIELD_HEIGHT * 2;
+  const size_t level = figure + 2 * 4 + 4 + 4;
+  const size_t status = level + 2 + 4;
+  const struct {
+    size_t offset;
+    uint8_t value;
+  } corruptions[] = {{figure + 2, 100}, {figure + 3, 60},
+                     {figure + 3, FIELD_HEIGHT + 1}, {figure + 2, 0xFE},
+                     {figure + 6, 3}, {level, 0}, {level, MAX_LEVEL + 1},
+                     {status, 5}, {status + 1, TICKS_START + 1}};
+  for (const auto &corruption : corruptions) {
+    uint8_t corrupted[TETRIS_CHECKPOINT_SIZE];
+    memcpy(corrupted, state, sizeof(state));
+    corrupted[corruption.offset] = corruption.value;
+    EXPECT_FALSE(restore_game(game, corrupted, sizeof(corrupted)))
+        << "offset " << corruption.offset;
+    EXPECT_EQ(hash_game(game), hash);
+  }
+
+  // A figure moved onto the blocks at the bottom of the field.
+  uint8_t buried[TETRIS_CHECKPOINT_SIZE];
+  memcpy(buried, state, sizeof(state));
+  for (int plane = 0; plane < CHECKPOINT_COLOR_PLANES; plane++) {
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      buried[(plane * FIELD_HEIGHT + row) * 2] = 0xFF;
+      buried[(plane * FIELD_HEIGHT + row) * 2 + 1] = 0x03;
+    }
+  }
+  buried[figure + 3] = FIELD_HEIGHT / 2;
+  EXPECT_FALSE(restore_game(game, buried, sizeof(buried)));
+
+  ASSERT_TRUE(restore_game(game, state, sizeof(state)));
+  EXPECT_EQ(hash_game(game), hash);
+  for (int i = 0; i < 100; i++) tick_game(game);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, SnakeReplayReproducesGame) {
+  s21::GameModel model(false, 99);
+  s21::GameController controller(&model);
+  Replay replay;
+  replay_init(&replay, REPLAY_SNAKE, 0, model.GetSeed());
+  model.SetRecorder(&replay);
+
+  const UserAction_t turns[] = {Up, Left, Down, Right, Start};
+  controller.userInput(Start, false);
+  for (int i = 0; i < 500; i++) {
+    controller.userInput(turns[i % 5], i % 3 == 0);
+    for (int step = 0; step < i % 6; step++) model.UpdateGame();
+  }
+  replay.final_hash = model.StateHash();
+  model.SetRecorder(nullptr);
+
+  ASSERT_EQ(s21::ReplaySnake(&replay), replay.final_hash);
+  ASSERT_GT(replay.checkpoint_count, 2u);
+  const ReplayCheckpoint *last = replay_find_checkpoint(&replay, replay.steps);
+  ASSERT_TRUE(model.Restore(replay_checkpoint_state(&replay, last),
+                            last->size));
+
+  Replay unindexed = replay;
+  unindexed.checkpoint_count = 0;
+  for (unsigned long step = 0; step <= replay.steps; step += 61) {
+    s21::GameModel seeked(false, replay.seed);
+    s21::GameModel simulated(false, replay.seed);
+    s21::SeekSnake(&replay, step, &seeked);
+    s21::SeekSnake(&unindexed, step, &simulated);
+    ASSERT_EQ(seeked.StateHash(), simulated.StateHash());
+  }
+  replay_free(&replay);
+}
+
+TEST(brick_game_tests, LibraryRejectsUnknownGame) {
+  const uint64_t seed = 7;
+  BgEnv *env = nullptr;
+  EXPECT_EQ(bg_create_batch(static_cast<BgGame>(2), &seed, 1, &env), -1);
+  EXPECT_EQ(env, nullptr);
+}
+
+TEST(brick_game_tests, LibraryStepMatchesEngine) {
+  const uint64_t seed = 7;
+  BgEnv *env;
+  BgObservation obs;
+  ASSERT_EQ(bg_create_batch(BG_TETRIS, &seed, 1, &env), 0);
+  bg_reset_batch(&env, &seed, 1, &obs);
+
+  GameInfo_t *game = game_init_seeded(PIECES_BAG, seed);
+  spawn_new(game);
+  apply_user_action(game, Start);
+  const UserAction_t engine_actions[] = {IDLE, Left, Right, Up, Down, Action};
+  Frame frame;
+  for (int step = 0; !obs.done; step++) {
+    int32_t action = step % 11 == 0 ? BG_ACTION : step % 6;
+    bg_step_batch(&env, &action, 1, &obs);
+    game->action = engine_actions[action];
+    calculate_game(game);
+
+    snapshot_game(game, &frame);
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      ASSERT_EQ(memcmp(obs.field[row], frame.field[row], FIELD_WIDTH), 0);
+    }
+    ASSERT_EQ(obs.score, game->score);
+    ASSERT_EQ(obs.steps, step + 1);
+  }
+  ASSERT_EQ(obs.status, BG_GAME_OVER);
+  ASSERT_EQ(game->status, GAMEOVER);
+
+  int32_t action = BG_LEFT;
+  bg_step_batch(&env, &action, 1, &obs);
+  ASSERT_TRUE(obs.done);
+  ASSERT_EQ(obs.reward, 0);
+  bg_destroy_batch(&env, 1);
+  ASSERT_EQ(env, nullptr);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, LibraryStepsWithoutAllocating) {
+#ifndef COUNT_ALLOCATIONS
+  GTEST_SKIP() << "allocation counting needs glibc";
+#else
+  const uint64_t seeds[] = {1, 2, 3, 4};
+  BgEnv *envs[4];
+  BgObservation obs[4];
+  ASSERT_EQ(bg_create_batch(BG_TETRIS, seeds, 2, envs), 0);
+  ASSERT_EQ(bg_create_batch(BG_SNAKE, seeds + 2, 2, envs + 2), 0);
+
+  long before = allocation_count.load();
+  int episodes = 0;
+  for (int step = 0; step < 20000; step++) {
+    int32_t actions[4];
+    for (int i = 0; i < 4; i++) actions[i] = (step / 3 + i) % 6;
+    bg_step_batch(envs, actions, 4, obs);
+    for (int i = 0; i < 4; i++) {
+      if (obs[i].done) {
+        episodes++;
+        bg_reset_batch(&envs[i], nullptr, 1, &obs[i]);
+      }
+    }
+  }
+  long allocations = allocation_count.load() - before;
+
+  bg_destroy_batch(envs, 4);
+  ASSERT_GT(episodes, 4);
+  ASSERT_EQ(allocations, 0);
+#endif
+}
+
 TEST(brick_game_tests, CalculateLevel) {
   GameInfo_t *game = game_init();
 
@@ -786,6 +1458,286 @@ TEST(brick_game_tests, GetUserActionStart) {
   free_game_init(game);
 }
 
+TEST(brick_game_tests, RotateFullTurn) {
+  GameInfo_t *game = game_init();
+  for (int num = 0; num < FIGURES_COUNT; num++) {
+    game->figure->figure_num = num;
+    get_random_figure(game->figure);
+    int start[FIGURE_SIZE][FIGURE_SIZE];
+    for (int i = 0; i < FIGURE_SIZE; i++) {
+      for (int j = 0; j < FIGURE_SIZE; j++) {
+        start[i][j] = game->figure->figure[i][j];
+      }
+    }
+    for (int r = 0; r < FIGURE_ROTATIONS; r++) rotate(game);
+    ASSERT_EQ(game->figure->rotation, 0);
+    for (int i = 0; i < FIGURE_SIZE; i++) {
+      for (int j = 0; j < FIGURE_SIZE; j++) {
+        ASSERT_EQ(game->figure->figure[i][j], start[i][j]);
+      }
+    }
+  }
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, RotateKeepsRandomSequence) {
+  GameInfo_t *game = game_init();
+  game->figure->figure_num = 2;
+  get_random_figure(game->figure);
+
+  srand(42);
+  int expected = rand();
+  srand(42);
+  rotate(game);
+  action_up(game);
+  ASSERT_EQ(rand(), expected);
+
+  ASSERT_EQ(game->figure->rotation, 2);
+  ASSERT_EQ(game->figure->figure[3][0], 3);
+  ASSERT_EQ(game->figure->figure[3][1], 3);
+  ASSERT_EQ(game->figure->figure[3][2], 3);
+  ASSERT_EQ(game->figure->figure[4][1], 3);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, BitboardLoadAndStore) {
+  GameInfo_t *game = game_init();
+  game->field[FIELD_HEIGHT - 1][0] = 3;
+  game->field[5][9] = 7;
+
+  Bitboard board;
+  bitboard_load_field(&board, game->field);
+  ASSERT_EQ(board.rows[0], BITBOARD_EMPTY_ROW);
+  ASSERT_EQ(board.rows[5], BITBOARD_EMPTY_ROW | (1 << (9 + BITBOARD_WALL)));
+
+  FieldRow *field = init_game_field();
+  bitboard_store_field(&board, field);
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      ASSERT_EQ(field[i][j], game->field[i][j]);
+    }
+  }
+  free_game_field(field);
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, BitboardCollisionMatchesField) {
+  GameInfo_t *game = game_init();
+  for (int j = 0; j < FIELD_WIDTH - 1; j++) {
+    game->field[FIELD_HEIGHT - 1][j] = 1;
+  }
+  game->field[10][4] = 2;
+
+  Bitboard board;
+  bitboard_load_field(&board, game->field);
+  for (int num = 0; num < FIGURES_COUNT; num++) {
+    game->figure->figure_num = num;
+    get_random_figure(game->figure);
+    uint8_t masks[FIGURE_SIZE];
+    bitboard_figure_masks(game->figure, masks);
+    for (int y = -2; y < FIELD_HEIGHT + 2; y++) {
+      for (int x = -4; x < FIELD_WIDTH + 2; x++) {
+        game->figure->x = x;
+        game->figure->y = y;
+        ASSERT_EQ(bitboard_collision(&board, masks, x, y), collision(game));
+      }
+    }
+  }
+  free_game_init(game);
+}
+
+TEST(brick_game_tests, BitboardEraseMatchesField) {
+  GameInfo_t *game = game_init();
+  for (int i = FIELD_HEIGHT - 4; i < FIELD_HEIGHT; i++) {
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      game->field[i][j] = i % 2 == 0 || j != 3 ? 1 + j % 7 : 0;
+    }
+  }
+  game->field[FIELD_HEIGHT - 5][2] = 5;
+
+  Bitboard board;
+  bitboard_load_field(&board, game->field);
+  int count = bitboard_erase_filled_lines(&board);
+  erase_and_score(game);
+
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(score_for_lines(count), game->score);
+  FieldRow *field = init_game_field();
+  bitboard_store_field(&board, field);
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    ASSERT_EQ(bitboard_check_filled_line(&board, i), 0);
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      ASSERT_EQ(field[i][j], game->field[i][j]);
+    }
+  }
+  free_game_field(field);
+  free_game_init(game);
+}
+
+// Steps a batch and one scalar game per board with the same random actions
+// and checks every board against its game after every step. Half of the
+// boards start with full rows under a row missing one cell, so the first
+// planted figure clears lines; every fourth board also has a block in row 0.
+static int run_batch_against_engine(bool simd) {
+  const int count = 21;
+  TetrisBatch *batch = tetris_batch_init(count);
+  batch->simd = simd;
+  std::vector<GameInfo_t *> games;
+  for (int board = 0; board < count; board++) {
+    GameInfo_t *game =
+        game_init_seeded((PieceMode)(board % 3), 1000 + board);
+    spawn_new(game);
+    if (board % 2 == 1) {
+      for (int i = FIELD_HEIGHT - 4; i < FIELD_HEIGHT; i++) {
+        for (int j = i == FIELD_HEIGHT - 4; j < FIELD_WIDTH; j++) {
+          game->field[i][j] = 1 + (i + j) % 7;
+        }
+      }
+      // A block in row 0 is copied down, not cleared, when lines drop.
+      if (board % 4 == 3) game->field[0][0] = 5;
+      tetris_batch_load(batch, board, game);
+    } else {
+      tetris_batch_reset(batch, board, (PieceMode)(board % 3), 1000 + board);
+    }
+    games.push_back(game);
+  }
+
+  static const UserAction_t choices[] = {Left, Left,  Left, Right, Up,
+                                         Up,   Down,  IDLE, IDLE,  Action};
+  std::mt19937 random(7);
+  GameInfo_t *stored = game_init_seeded(PIECES_BAG, 0);
+  uint8_t actions[count];
+  int cleared = 0;
+  for (int step = 0; step < 3000; step++) {
+    for (int board = 0; board < count; board++) {
+      int roll = random() % 100;
+      actions[board] = roll == 0   ? Pause
+                       : roll < 4  ? Start
+                                   : choices[roll % 10];
+      GameInfo_t *game = games[board];
+      if (batch->over[board]) continue;
+      int score = game->score;
+      game->action = (UserAction_t)actions[board];
+      calculate_game(game);
+      if (game->score != score) cleared++;
+    }
+    tetris_batch_step(batch, actions);
+    for (int board = 0; board < count; board++) {
+      tetris_batch_store(batch, board, stored);
+      EXPECT_EQ(hash_game(stored), hash_game(games[board]))
+          << "board " << board << " step " << step;
+      EXPECT_EQ(stored->ticks_left, games[board]->ticks_left);
+      EXPECT_EQ(stored->generator->dealt, games[board]->generator->dealt);
+    }
+    if (::testing::Test::HasFailure()) break;
+  }
+  free_game_init(stored);
+  for (GameInfo_t *game : games) free_game_init(game);
+  tetris_batch_free(batch);
+  return cleared;
+}
+
+TEST(brick_game_tests, BatchMatchesEngine) {
+  EXPECT_GT(run_batch_against_engine(false), 0);
+  if (tetris_batch_simd_available()) {
+    EXPECT_GT(run_batch_against_engine(true), 0);
+  }
+}
+
+TEST(brick_game_tests, BotClearsLines) {
+  for (int depth = 1; depth <= TETRIS_BOT_MAX_DEPTH; depth++) {
+    GameInfo_t *game = game_init_seeded(PIECES_BAG, 5);
+    spawn_new(game);
+    apply_user_action(game, Start);
+    TetrisBot bot;
+    tetris_bot_init(&bot, depth);
+    for (int step = 0; step < 10000 && game->status != GAMEOVER; step++) {
+      game->action = tetris_bot_action(&bot, game);
+      calculate_game(game);
+    }
+    EXPECT_NE(game->status, GAMEOVER) << "depth " << depth;
+    EXPECT_GE(game->score, 50000) << "depth " << depth;
+    free_game_init(game);
+  }
+}
+
+TEST(brick_game_tests, SnakeBotWins) {
+  for (uint64_t seed = 1; seed <= 3; seed++) {
+    s21::GameModel model(false, seed);
+    s21::GameController controller(&model);
+    s21::SnakeBot bot;
+    controller.userInput(Start, false);
+    // A few turns by hand, so the bot starts off its cycle.
+    const UserAction_t turns[] = {Left, Up, Right};
+    for (UserAction_t turn : turns) {
+      controller.userInput(turn, false);
+      model.UpdateGame();
+    }
+
+#ifdef COUNT_ALLOCATIONS
+    long before = allocation_count.load();
+#endif
+    long ticks = 0;
+    while (model.GetGameState() == Running && ticks < 20000) {
+      UserAction_t action = bot.NextAction(model);
+      if (action != IDLE) controller.userInput(action, false);
+      model.UpdateGame();
+      ++ticks;
+    }
+#ifdef COUNT_ALLOCATIONS
+    EXPECT_EQ(allocation_count.load() - before, 0) << "seed " << seed;
+#endif
+    EXPECT_EQ(model.GetGameState(), Win) << "seed " << seed;
+    EXPECT_EQ(model.GetScore(), 196) << "seed " << seed;
+  }
+}
+
+TEST(brick_game_tests, WorkPoolRunsEveryTaskOnce) {
+  s21::WorkPool pool(4);
+  ASSERT_EQ(pool.Threads(), 4);
+  for (int count : {0, 3, 1000}) {
+    std::vector<std::atomic<int>> runs(count);
+    std::atomic<bool> bad_worker{false};
+    pool.Run(count, [&](int index, int worker) {
+      if (worker < 0 || worker >= pool.Threads()) bad_worker = true;
+      runs[index]++;
+      // Tasks at the front are much longer, so the other workers steal.
+      volatile long spin = 0;
+      for (long i = 0; i < (index < count / 8 ? 200000 : 100); i++) spin += i;
+    });
+    EXPECT_FALSE(bad_worker);
+    for (int i = 0; i < count; i++) {
+      EXPECT_EQ(runs[i].load(), 1) << "task " << i << " of " << count;
+    }
+  }
+}
+
+TEST(brick_game_tests, SimReportDoesNotDependOnThreads) {
+  for (s21::SimGame game : {s21::SimGame::tetris, s21::SimGame::snake}) {
+    for (int bot : {0, 1}) {
+      s21::SimOptions options;
+      options.game = game;
+      options.games = 9;
+      options.seed = 5;
+      options.max_ticks = 3000;
+      options.bot = bot;
+      options.threads = 1;
+      s21::SimReport single = s21::RunSimulation(options);
+      options.threads = 3;
+      s21::SimReport parallel = s21::RunSimulation(options);
+      EXPECT_EQ(single.failed, 0);
+      EXPECT_EQ(parallel.failed, 0);
+      ASSERT_EQ(parallel.results.size(), single.results.size());
+      for (size_t i = 0; i < single.results.size(); i++) {
+        EXPECT_EQ(parallel.results[i].score, single.results[i].score)
+            << "game " << i << " bot " << bot;
+        EXPECT_EQ(parallel.results[i].ticks, single.results[i].ticks)
+            << "game " << i << " bot " << bot;
+      }
+    }
+  }
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();